@@ -8,10 +8,25 @@
 #include <iostream>
 #include <string>
 #include <vector>
+#include <list>
 #include <array>
+#include <utility>
 #include <memory>
+#include <memory_resource>
+#include <new>
+#include <optional>
+#include <variant>
+#include <span>
+#include <string_view>
+#include <charconv>
+#include <cstdio>
+#include <cstring>
 #include <algorithm>
+#include <numeric>
+#include <limits>
 #include <map>
+#include <unordered_map>
+#include <unordered_set>
 #include <set>
 #include <queue>
 #include <stack>
@@ -19,10 +34,52 @@
 #include <sstream>
 #include <thread>
 #include <mutex>
+#include <atomic>
 #include <future>
+#include <condition_variable>
+#include <deque>
+#include <type_traits>
 #include <chrono>
 #include <functional>
 #include <exception>
+#include <iomanip>
+#include <random>
+#include <cstdint>
+#include <bit>
+#include <numbers>
+
+// std::execution needs TBB with libstdc++; build with
+// -DGUIDE_PARALLEL_STL -ltbb to include it in the sort benchmark
+#ifdef GUIDE_PARALLEL_STL
+#include <execution>
+#endif
+
+// Per-type construction/copy/move counters; build with
+// -DGUIDE_LIFECYCLE_STATS to turn them on (they cost nothing otherwise)
+#ifdef GUIDE_LIFECYCLE_STATS
+#include <typeindex>
+#include <typeinfo>
+#if defined(__GNUG__)
+#include <cxxabi.h>
+#endif
+#endif
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#define GUIDE_POSIX 1
+#else
+#define GUIDE_POSIX 0
+#endif
+
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#include <immintrin.h>
+#define GUIDE_X86_SIMD 1
+#else
+#define GUIDE_X86_SIMD 0
+#endif
 
 using namespace std;
 
@@ -298,7 +355,184 @@ void arrayExamples() {
     }
 }
 
-// 4.2 String Operations
+// 4.2 Fast Number Parsing
+// stoi and stringstream are locale-aware, allocate and report errors by
+// throwing. These parse straight from a string_view with from_chars, and
+// integers read eight digits at a time (SWAR: SIMD within a register).
+enum class ParseError { NONE, EMPTY, INVALID, OUT_OF_RANGE };
+
+template<typename T>
+struct NumberParse {
+    T value{};
+    ParseError error = ParseError::NONE;
+    size_t consumed = 0;  // Characters used, like from_chars' ptr
+    
+    explicit operator bool() const { return error == ParseError::NONE; }
+};
+
+// True if all eight bytes are ASCII '0'..'9'
+inline bool isEightDigits(uint64_t chunk) {
+    return ((chunk & 0xF0F0F0F0F0F0F0F0ULL) |
+            (((chunk + 0x0606060606060606ULL) & 0xF0F0F0F0F0F0F0F0ULL) >> 4)) == 0x3333333333333333ULL;
+}
+
+// Value of eight ASCII digits loaded little-endian: pairs, then quads, then all
+inline uint32_t parseEightDigits(uint64_t chunk) {
+    const uint64_t mask = 0x000000FF000000FFULL;
+    const uint64_t mul1 = 100 + (1000000ULL << 32);
+    const uint64_t mul2 = 1 + (10000ULL << 32);
+    chunk -= 0x3030303030303030ULL;
+    chunk = (chunk * 10) + (chunk >> 8);
+    chunk = (((chunk & mask) * mul1) + (((chunk >> 16) & mask) * mul2)) >> 32;
+    return static_cast<uint32_t>(chunk);
+}
+
+template<typename T>
+NumberParse<T> parseInteger(string_view text) {
+    static_assert(is_integral<T>::value, "parseInteger needs an integer type");
+    NumberParse<T> result;
+    if (text.empty()) {
+        result.error = ParseError::EMPTY;
+        return result;
+    }
+    
+    const char* p = text.data();
+    const char* end = p + text.size();
+    bool negative = (*p == '-');
+    if (*p == '-' || *p == '+') p++;
+    if (negative && is_unsigned<T>::value) {
+        result.error = ParseError::INVALID;
+        return result;
+    }
+    
+    const char* digits = p;
+    while (p < end && *p == '0') p++;
+    const char* significant = p;
+    
+    // Up to 19 significant digits always fit in a uint64_t
+    uint64_t value = 0;
+    if (endian::native == endian::little) {
+        while (end - p >= 8 && p - significant <= 11) {
+            uint64_t chunk;
+            memcpy(&chunk, p, 8);
+            if (!isEightDigits(chunk)) break;
+            value = value * 100000000 + parseEightDigits(chunk);
+            p += 8;
+        }
+    }
+    while (p < end && *p >= '0' && *p <= '9' && p - significant < 19) {
+        value = value * 10 + static_cast<uint64_t>(*p - '0');
+        p++;
+    }
+    
+    if (p == digits) {
+        result.error = ParseError::INVALID;
+        return result;
+    }
+    if (p < end && *p >= '0' && *p <= '9') {
+        // Too long for the fast path; from_chars sorts out the range
+        auto parsed = from_chars(digits - (negative ? 1 : 0), end, result.value);
+        result.consumed = parsed.ptr - text.data();
+        if (parsed.ec == errc::result_out_of_range) result.error = ParseError::OUT_OF_RANGE;
+        return result;
+    }
+    
+    using U = make_unsigned_t<T>;
+    uint64_t limit = negative ? uint64_t(U(numeric_limits<T>::max())) + 1 : uint64_t(numeric_limits<U>::max() >> (is_signed<T>::value ? 1 : 0));
+    result.consumed = p - text.data();
+    if (value > limit) {
+        result.error = ParseError::OUT_OF_RANGE;
+        return result;
+    }
+    result.value = negative ? static_cast<T>(U(0) - static_cast<U>(value)) : static_cast<T>(value);
+    return result;
+}
+
+template<typename T>
+NumberParse<T> parseFloating(string_view text) {
+    NumberParse<T> result;
+    if (text.empty()) {
+        result.error = ParseError::EMPTY;
+        return result;
+    }
+    size_t skip = (text[0] == '+' && text.size() > 1 && text[1] != '-') ? 1 : 0;
+    auto parsed = from_chars(text.data() + skip, text.data() + text.size(), result.value);
+    if (parsed.ec == errc::invalid_argument) {
+        result.error = ParseError::INVALID;
+        return result;
+    }
+    if (parsed.ec == errc::result_out_of_range) result.error = ParseError::OUT_OF_RANGE;
+    result.consumed = parsed.ptr - text.data();
+    return result;
+}
+
+// Parses a number at the start of text; check consumed to reject trailing junk
+template<typename T>
+NumberParse<T> parseNumber(string_view text) {
+    if constexpr (is_integral<T>::value) {
+        return parseInteger<T>(text);
+    } else {
+        static_assert(is_floating_point<T>::value, "parseNumber needs an arithmetic type");
+        return parseFloating<T>(text);
+    }
+}
+
+// Splits text on whitespace and converts tokens on request
+class Tokenizer {
+private:
+    string_view rest;
+    ParseError lastError = ParseError::NONE;
+    
+    static bool isSpace(char c) {
+        return c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\f' || c == '\v';
+    }
+    
+public:
+    explicit Tokenizer(string_view text) : rest(text) {}
+    
+    bool next(string_view& token) {
+        size_t start = 0;
+        while (start < rest.size() && isSpace(rest[start])) start++;
+        size_t stop = start;
+        while (stop < rest.size() && !isSpace(rest[stop])) stop++;
+        if (start == stop) {
+            rest = string_view();
+            lastError = ParseError::EMPTY;
+            return false;
+        }
+        token = rest.substr(start, stop - start);
+        rest.remove_prefix(stop);
+        return true;
+    }
+    
+    // The whole next token must be a number of type T. Parses straight from
+    // the remaining text so the token is only scanned once.
+    template<typename T>
+    bool next(T& value) {
+        size_t start = 0;
+        while (start < rest.size() && isSpace(rest[start])) start++;
+        rest.remove_prefix(start);
+        if (rest.empty()) {
+            lastError = ParseError::EMPTY;
+            return false;
+        }
+        NumberParse<T> parsed = parseNumber<T>(rest);
+        if (parsed.error != ParseError::NONE ||
+            (parsed.consumed < rest.size() && !isSpace(rest[parsed.consumed]))) {
+            lastError = parsed.error != ParseError::NONE ? parsed.error : ParseError::INVALID;
+            string_view skipped;
+            next(skipped);
+            return false;
+        }
+        rest.remove_prefix(parsed.consumed);
+        value = parsed.value;
+        return true;
+    }
+    
+    ParseError error() const { return lastError; }
+};
+
+// 4.3 String Operations
 void stringExamples() {
     cout << "\n=== STRINGS ===" << endl;
     
@@ -322,10 +556,13 @@ void stringExamples() {
     string converted(cstr);
     cout << "Converted: " << converted << endl;
     
-    // String to number conversion
+    // String to number conversion (no exceptions, no allocation)
     string numStr = "42";
-    int num = stoi(numStr);
-    cout << "String to int: " << num << endl;
+    NumberParse<int> num = parseNumber<int>(numStr);
+    cout << "String to int: " << num.value << endl;
+    
+    NumberParse<int> bad = parseNumber<int>("99999999999");
+    cout << "Out of range detected: " << boolalpha << (bad.error == ParseError::OUT_OF_RANGE) << endl;
 }
 
 /*
@@ -406,6 +643,166 @@ void dynamicMemory() {
     delete[] dynamicArray;  // Use delete[] for arrays
 }
 
+// 5.4 Lifecycle Tracking
+// A class opts in by holding a LifecycleTracker<Self> member: the tracker's
+// own constructors, assignments and destructor count for the class, so the
+// defaulted copy/move members of the class count correctly without change.
+// Counts live in per-thread, per-type blocks (no shared cache lines) and are
+// summed when a report is asked for. Without GUIDE_LIFECYCLE_STATS the
+// tracker is an empty [[no_unique_address]] member and adds nothing.
+#ifdef GUIDE_LIFECYCLE_STATS
+class LifecycleStats {
+public:
+    enum Event { CONSTRUCTION, COPY, MOVE, DESTRUCTION, BYTES, EVENT_COUNT };
+    
+    // Copies and moves include assignments
+    struct Counts {
+        uint64_t constructions = 0;
+        uint64_t copies = 0;
+        uint64_t moves = 0;
+        uint64_t destructions = 0;
+        uint64_t bytes = 0;
+    };
+    
+private:
+    using Values = array<uint64_t, EVENT_COUNT>;
+    
+    // Written only by its own thread; relaxed atomics let reports read it
+    struct ThreadCounts {
+        type_index type;
+        array<atomic<uint64_t>, EVENT_COUNT> values{};
+        
+        explicit ThreadCounts(type_index t) : type(t) {
+            Registry& r = registry();
+            lock_guard<mutex> guard(r.lock);
+            r.live.push_back(this);
+        }
+        
+        ~ThreadCounts();
+    };
+    
+    struct Registry {
+        mutex lock;
+        vector<ThreadCounts*> live;
+        map<type_index, Values> retired;    // Counts of threads that have exited
+    };
+    
+    static Registry& registry() {
+        static Registry instance;
+        return instance;
+    }
+    
+    template<typename T>
+    static ThreadCounts* local(bool& destroyed) {
+        thread_local bool gone = false;
+        destroyed = gone;
+        if (gone) return nullptr;
+        thread_local struct Holder {
+            ThreadCounts counts{type_index(typeid(T))};
+            ~Holder() { gone = true; }
+        } holder;
+        return &holder.counts;
+    }
+    
+    static string typeName(type_index type) {
+#if defined(__GNUG__)
+        int status = 0;
+        unique_ptr<char, void (*)(void*)> demangled(
+            abi::__cxa_demangle(type.name(), nullptr, nullptr, &status), free);
+        if (status == 0) return demangled.get();
+#endif
+        return type.name();
+    }
+    
+public:
+    template<typename T>
+    static void record(Event event, uint64_t n = 1) {
+        bool destroyed = false;
+        ThreadCounts* counts = local<T>(destroyed);
+        if (counts != nullptr) {
+            atomic<uint64_t>& value = counts->values[event];
+            value.store(value.load(memory_order_relaxed) + n, memory_order_relaxed);
+            return;
+        }
+        // Thread is exiting and its block is gone: count straight into the totals
+        Registry& r = registry();
+        lock_guard<mutex> guard(r.lock);
+        r.retired[type_index(typeid(T))][event] += n;
+    }
+    
+    // Totals per type name over live and exited threads
+    static map<string, Counts> snapshot() {
+        Registry& r = registry();
+        lock_guard<mutex> guard(r.lock);
+        map<type_index, Values> totals = r.retired;
+        for (const ThreadCounts* counts : r.live) {
+            Values& sum = totals[counts->type];
+            for (size_t e = 0; e < EVENT_COUNT; e++) {
+                sum[e] += counts->values[e].load(memory_order_relaxed);
+            }
+        }
+        
+        map<string, Counts> result;
+        for (const auto& [type, v] : totals) {
+            result[typeName(type)] = Counts{v[CONSTRUCTION], v[COPY], v[MOVE], v[DESTRUCTION], v[BYTES]};
+        }
+        return result;
+    }
+    
+    static void report(ostream& out = cout) {
+        out << "\n=== LIFECYCLE REPORT ===" << endl;
+        out << left << setw(40) << "type" << right << setw(12) << "constructed"
+            << setw(10) << "copies" << setw(10) << "moves" << setw(12) << "destroyed"
+            << setw(14) << "bytes" << endl;
+        for (const auto& [name, c] : snapshot()) {
+            out << left << setw(40) << name << right << setw(12) << c.constructions
+                << setw(10) << c.copies << setw(10) << c.moves << setw(12) << c.destructions
+                << setw(14) << c.bytes << endl;
+        }
+    }
+};
+
+LifecycleStats::ThreadCounts::~ThreadCounts() {
+    Registry& r = registry();
+    lock_guard<mutex> guard(r.lock);
+    Values& sum = r.retired[type];
+    for (size_t e = 0; e < EVENT_COUNT; e++) {
+        sum[e] += values[e].load(memory_order_relaxed);
+    }
+    r.live.erase(find(r.live.begin(), r.live.end(), this));
+}
+
+template<typename T>
+struct LifecycleTracker {
+    LifecycleTracker() { LifecycleStats::record<T>(LifecycleStats::CONSTRUCTION); }
+    LifecycleTracker(const LifecycleTracker&) { LifecycleStats::record<T>(LifecycleStats::COPY); }
+    LifecycleTracker(LifecycleTracker&&) noexcept { LifecycleStats::record<T>(LifecycleStats::MOVE); }
+    
+    LifecycleTracker& operator=(const LifecycleTracker&) {
+        LifecycleStats::record<T>(LifecycleStats::COPY);
+        return *this;
+    }
+    
+    LifecycleTracker& operator=(LifecycleTracker&&) noexcept {
+        LifecycleStats::record<T>(LifecycleStats::MOVE);
+        return *this;
+    }
+    
+    ~LifecycleTracker() { LifecycleStats::record<T>(LifecycleStats::DESTRUCTION); }
+    
+    static void allocated(size_t bytes) { LifecycleStats::record<T>(LifecycleStats::BYTES, bytes); }
+};
+#else
+template<typename T>
+struct LifecycleTracker {
+    static void allocated(size_t) {}
+};
+
+struct LifecycleStats {
+    static void report(ostream& = cout) {}
+};
+#endif
+
 /*
 ===============================================================================
                             6. CLASSES AND OBJECTS (OOP)
@@ -413,18 +810,42 @@ void dynamicMemory() {
 */
 
 // 6.1 Basic Class
-class Rectangle {
+// What a rectangle does when it is created, copied or destroyed is a policy.
+// The default does nothing, which keeps Rectangle trivially copyable and
+// destructible: a vector<Rectangle> can grow with memcpy and be freed
+// without visiting each element. Counting and logging are opt-in.
+struct TrivialLifecycle {};
+
+// Thread-safe count of live rectangles; each Tag gets its own counter, so
+// policies built on this one do not share a count with it
+template<typename Tag = void>
+struct CountedLifecycle {
+    static inline atomic<int> objectCount{0};
+    
+    CountedLifecycle() { objectCount.fetch_add(1, memory_order_relaxed); }
+    CountedLifecycle(const CountedLifecycle&) : CountedLifecycle() {}
+    CountedLifecycle& operator=(const CountedLifecycle&) = default;  // Count unchanged
+    ~CountedLifecycle() { objectCount.fetch_sub(1, memory_order_relaxed); }
+    
+    static int liveCount() { return objectCount.load(memory_order_relaxed); }
+};
+
+struct LoggedLifecycle : CountedLifecycle<LoggedLifecycle> {
+    ~LoggedLifecycle() {
+        cout << "Rectangle destroyed" << endl;
+    }
+};
+
+template<typename Lifecycle = TrivialLifecycle>
+class BasicRectangle {
 private:
     double width, height;
+    [[no_unique_address]] Lifecycle lifecycle;
+    [[no_unique_address]] LifecycleTracker<BasicRectangle> tracker;
 
 public:
     // Constructor
-    Rectangle(double w = 0, double h = 0) : width(w), height(h) {}
-    
-    // Destructor
-    ~Rectangle() {
-        cout << "Rectangle destroyed" << endl;
-    }
+    BasicRectangle(double w = 0, double h = 0) : width(w), height(h) {}
     
     // Getters (accessors)
     double getWidth() const { return width; }
@@ -447,19 +868,28 @@ public:
         return 2 * (width + height);
     }
     
-    // Static member
-    static int objectCount;
-    static int getObjectCount() { return objectCount; }
+    // Live rectangles; only for lifecycles that count them
+    static int getObjectCount() requires requires { Lifecycle::liveCount(); } {
+        return Lifecycle::liveCount();
+    }
     
     // Friend function declaration
-    friend void printRectangle(const Rectangle& r);
+    template<typename L>
+    friend void printRectangle(const BasicRectangle<L>& r);
 };
 
-// Static member definition
-int Rectangle::objectCount = 0;
+using Rectangle = BasicRectangle<>;
+using CountedRectangle = BasicRectangle<CountedLifecycle<>>;
+using LoggedRectangle = BasicRectangle<LoggedLifecycle>;
+
+#ifndef GUIDE_LIFECYCLE_STATS
+static_assert(is_trivially_copyable_v<Rectangle> && is_trivially_destructible_v<Rectangle>,
+              "Rectangle must stay trivially copyable and destructible");
+#endif
 
 // Friend function definition
-void printRectangle(const Rectangle& r) {
+template<typename L>
+void printRectangle(const BasicRectangle<L>& r) {
     cout << "Rectangle: " << r.width << " x " << r.height << endl;
 }
 
@@ -492,7 +922,11 @@ public:
         : Shape(c), radius(r) {}
     
     double area() const override {
-        return 3.14159 * radius * radius;
+        return numbers::pi * radius * radius;
+    }
+    
+    double perimeter() const {
+        return 2 * numbers::pi * radius;
     }
     
     void display() const override {
@@ -503,7 +937,321 @@ public:
     double getRadius() const { return radius; }
 };
 
-// 6.3 Polymorphism Example
+// 6.3 Structure-of-Arrays Shape Store
+// A vector<unique_ptr<Shape>> costs a pointer chase and an indirect call per
+// shape. When only the numbers matter, keeping each field in its own
+// contiguous array lets the compiler vectorize the whole batch.
+class ShapeStore {
+private:
+    vector<double> radii;                // Circles
+    vector<double> widths, heights;      // Rectangles
+    
+    static constexpr double CIRCLE_PI = numbers::pi;  // Matches Circle::area()
+    
+public:
+    void reserve(size_t circles, size_t rectangles) {
+        radii.reserve(circles);
+        widths.reserve(rectangles);
+        heights.reserve(rectangles);
+    }
+    
+    void addCircle(double radius) { radii.push_back(radius); }
+    
+    void addRectangle(double width, double height) {
+        widths.push_back(width);
+        heights.push_back(height);
+    }
+    
+    size_t circleCount() const { return radii.size(); }
+    size_t rectangleCount() const { return widths.size(); }
+    size_t size() const { return radii.size() + widths.size(); }
+    
+    void clear() {
+        radii.clear();
+        widths.clear();
+        heights.clear();
+    }
+    
+    // Four independent sums break the add dependency chain
+    double totalArea() const {
+        double sums[4] = {0, 0, 0, 0};
+        const double* r = radii.data();
+        size_t n = radii.size(), i = 0;
+        for (; i + 4 <= n; i += 4) {
+            for (size_t k = 0; k < 4; k++) sums[k] += r[i + k] * r[i + k];
+        }
+        for (; i < n; i++) sums[0] += r[i] * r[i];
+        double circles = CIRCLE_PI * ((sums[0] + sums[1]) + (sums[2] + sums[3]));
+        
+        sums[0] = sums[1] = sums[2] = sums[3] = 0;
+        const double* w = widths.data();
+        const double* h = heights.data();
+        n = widths.size();
+        for (i = 0; i + 4 <= n; i += 4) {
+            for (size_t k = 0; k < 4; k++) sums[k] += w[i + k] * h[i + k];
+        }
+        for (; i < n; i++) sums[0] += w[i] * h[i];
+        return circles + ((sums[0] + sums[1]) + (sums[2] + sums[3]));
+    }
+    
+    // Writes size() areas: all circles first, then all rectangles
+    void areas(double* out) const {
+        const double* r = radii.data();
+        for (size_t i = 0, n = radii.size(); i < n; i++) {
+            out[i] = CIRCLE_PI * r[i] * r[i];
+        }
+        out += radii.size();
+        const double* w = widths.data();
+        const double* h = heights.data();
+        for (size_t i = 0, n = widths.size(); i < n; i++) {
+            out[i] = w[i] * h[i];
+        }
+    }
+    
+    void areas(vector<double>& out) const {
+        out.resize(size());
+        areas(out.data());
+    }
+};
+
+// 6.4 Spatial Index
+// Shapes with a position, and an index that answers "what overlaps this
+// box" and "what is nearest to this point" without visiting every shape.
+enum class ShapeKind : uint8_t { CIRCLE, RECTANGLE };
+
+struct BoundingBox {
+    double minX, minY, maxX, maxY;
+    
+    bool intersects(const BoundingBox& other) const {
+        return minX <= other.maxX && other.minX <= maxX &&
+               minY <= other.maxY && other.minY <= maxY;
+    }
+    
+    void expand(const BoundingBox& other) {
+        minX = min(minX, other.minX);
+        minY = min(minY, other.minY);
+        maxX = max(maxX, other.maxX);
+        maxY = max(maxY, other.maxY);
+    }
+    
+    // Squared distance from a point to the box; 0 inside
+    double distanceSquared(double x, double y) const {
+        double dx = max({minX - x, 0.0, x - maxX});
+        double dy = max({minY - y, 0.0, y - maxY});
+        return dx * dx + dy * dy;
+    }
+};
+
+// Centered at (x, y); a circle's radius is stored as both half-extents
+struct PlacedShape {
+    uint32_t id;
+    ShapeKind kind;
+    double x, y;
+    double halfWidth, halfHeight;
+    
+    static PlacedShape circle(uint32_t id, double x, double y, double radius) {
+        return {id, ShapeKind::CIRCLE, x, y, radius, radius};
+    }
+    
+    static PlacedShape rectangle(uint32_t id, double x, double y, double width, double height) {
+        return {id, ShapeKind::RECTANGLE, x, y, width / 2, height / 2};
+    }
+    
+    BoundingBox bounds() const {
+        return {x - halfWidth, y - halfHeight, x + halfWidth, y + halfHeight};
+    }
+    
+    // Squared distance from a point to the shape's edge; 0 inside
+    double distanceSquared(double px, double py) const {
+        if (kind == ShapeKind::RECTANGLE) return bounds().distanceSquared(px, py);
+        double d = max(0.0, hypot(px - x, py - y) - halfWidth);
+        return d * d;
+    }
+};
+
+// Packed R-tree (sort-tile-recursive bulk load). Every level lives in one
+// flat array of boxes: the shapes first, then one box per NODE_SIZE children
+// for each level up to the root, so node i's children are simply
+// [i * NODE_SIZE, (i + 1) * NODE_SIZE) one level down. Inserts collect in a
+// small unindexed buffer and erases leave tombstones; both are folded in by
+// a rebuild once they grow past a threshold. Ids must be unique.
+class SpatialIndex {
+public:
+    static constexpr size_t NODE_SIZE = 16;
+    
+private:
+    vector<PlacedShape> items;        // In tree (leaf) order
+    vector<BoundingBox> boxes;        // Items, then each node level up to the root
+    vector<size_t> levelStart;        // Offset of each level in boxes, plus the end
+    vector<uint8_t> removed;          // Tombstones, parallel to items
+    size_t removedCount = 0;
+    vector<PlacedShape> pending;      // Inserted since the last build
+    
+    size_t levelCount() const { return levelStart.empty() ? 0 : levelStart.size() - 1; }
+    size_t levelSize(size_t level) const { return levelStart[level + 1] - levelStart[level]; }
+    
+    size_t pendingLimit() const {
+        return max<size_t>(256, 4 * static_cast<size_t>(sqrt(double(items.size()))));
+    }
+    
+    void rebuild() {
+        vector<PlacedShape> all;
+        all.reserve(size());
+        for (size_t i = 0; i < items.size(); i++) {
+            if (!removed[i]) all.push_back(items[i]);
+        }
+        all.insert(all.end(), pending.begin(), pending.end());
+        build(move(all));
+    }
+    
+public:
+    SpatialIndex() = default;
+    explicit SpatialIndex(vector<PlacedShape> shapes) { build(move(shapes)); }
+    
+    // Replaces the contents with shapes, bulk-loaded
+    void build(vector<PlacedShape> shapes) {
+        size_t n = shapes.size();
+        // Sort by x, cut into vertical slices of whole leaves, sort each by y
+        auto byX = [](const PlacedShape& a, const PlacedShape& b) { return a.x < b.x; };
+        auto byY = [](const PlacedShape& a, const PlacedShape& b) { return a.y < b.y; };
+        sort(shapes.begin(), shapes.end(), byX);
+        size_t leaves = (n + NODE_SIZE - 1) / NODE_SIZE;
+        size_t slices = max<size_t>(1, static_cast<size_t>(ceil(sqrt(double(leaves)))));
+        size_t sliceSize = ((leaves + slices - 1) / slices) * NODE_SIZE;
+        for (size_t begin = 0; begin < n; begin += sliceSize) {
+            size_t end = min(n, begin + sliceSize);
+            sort(shapes.begin() + begin, shapes.begin() + end, byY);
+        }
+        
+        items = move(shapes);
+        removed.assign(n, 0);
+        removedCount = 0;
+        pending.clear();
+        boxes.clear();
+        levelStart.assign(1, 0);
+        if (n == 0) return;
+        
+        boxes.reserve(n + n / (NODE_SIZE - 1) + 1);
+        for (const auto& shape : items) boxes.push_back(shape.bounds());
+        levelStart.push_back(boxes.size());
+        while (levelSize(levelCount() - 1) > 1) {
+            size_t childStart = levelStart[levelCount() - 1];
+            size_t childEnd = levelStart[levelCount()];
+            for (size_t i = childStart; i < childEnd; i += NODE_SIZE) {
+                BoundingBox box = boxes[i];
+                for (size_t c = i + 1; c < min(childEnd, i + NODE_SIZE); c++) box.expand(boxes[c]);
+                boxes.push_back(box);
+            }
+            levelStart.push_back(boxes.size());
+        }
+    }
+    
+    void insert(const PlacedShape& shape) {
+        pending.push_back(shape);
+        if (pending.size() > pendingLimit()) rebuild();
+    }
+    
+    // Needs the shape's position to find it; false if it is not in the index
+    bool erase(const PlacedShape& shape) {
+        for (size_t i = 0; i < pending.size(); i++) {
+            if (pending[i].id == shape.id) {
+                pending[i] = pending.back();
+                pending.pop_back();
+                return true;
+            }
+        }
+        
+        bool found = false;
+        forEachItem(shape.bounds(), [&](size_t slot) {
+            if (!found && items[slot].id == shape.id) {
+                removed[slot] = 1;
+                removedCount++;
+                found = true;
+            }
+        });
+        if (found && removedCount > items.size() / 4) rebuild();
+        return found;
+    }
+    
+    size_t size() const { return items.size() - removedCount + pending.size(); }
+    bool empty() const { return size() == 0; }
+    
+    // Calls visit(slot) for each live indexed item whose box meets query
+    template<typename F>
+    void forEachItem(const BoundingBox& query, F&& visit) const {
+        if (items.empty()) return;
+        vector<pair<size_t, size_t>> stack;  // {level, index within level}
+        size_t top = levelCount() - 1;
+        for (size_t i = 0; i < levelSize(top); i++) stack.push_back({top, i});
+        while (!stack.empty()) {
+            auto [level, index] = stack.back();
+            stack.pop_back();
+            if (!boxes[levelStart[level] + index].intersects(query)) continue;
+            if (level == 0) {
+                if (!removed[index]) visit(index);
+                continue;
+            }
+            size_t first = index * NODE_SIZE;
+            size_t last = min(levelSize(level - 1), first + NODE_SIZE);
+            for (size_t c = first; c < last; c++) stack.push_back({level - 1, c});
+        }
+    }
+    
+    // Ids of shapes whose bounding box overlaps query
+    vector<uint32_t> range(const BoundingBox& query) const {
+        vector<uint32_t> result;
+        forEachItem(query, [&](size_t slot) { result.push_back(items[slot].id); });
+        for (const auto& shape : pending) {
+            if (shape.bounds().intersects(query)) result.push_back(shape.id);
+        }
+        return result;
+    }
+    
+    // Up to k {distance, id} pairs, nearest first. Best-first search: box
+    // distances are lower bounds, so a shape popped off the queue is closer
+    // than anything still waiting in it.
+    vector<pair<double, uint32_t>> nearest(double x, double y, size_t k) const {
+        struct Candidate {
+            double distanceSquared;
+            size_t level;       // 0 = indexed shape, SIZE_MAX = pending shape
+            size_t index;
+            bool operator>(const Candidate& other) const { return distanceSquared > other.distanceSquared; }
+        };
+        priority_queue<Candidate, vector<Candidate>, greater<Candidate>> queue;
+        if (!items.empty()) {
+            size_t top = levelCount() - 1;
+            for (size_t i = 0; i < levelSize(top); i++) {
+                double d = top == 0 ? items[i].distanceSquared(x, y) : boxes[levelStart[top] + i].distanceSquared(x, y);
+                queue.push({d, top, i});
+            }
+        }
+        for (size_t i = 0; i < pending.size(); i++) {
+            queue.push({pending[i].distanceSquared(x, y), SIZE_MAX, i});
+        }
+        
+        vector<pair<double, uint32_t>> result;
+        while (!queue.empty() && result.size() < k) {
+            Candidate c = queue.top();
+            queue.pop();
+            if (c.level == SIZE_MAX) {
+                result.push_back({sqrt(c.distanceSquared), pending[c.index].id});
+            } else if (c.level == 0) {
+                if (!removed[c.index]) result.push_back({sqrt(c.distanceSquared), items[c.index].id});
+            } else {
+                size_t first = c.index * NODE_SIZE;
+                size_t last = min(levelSize(c.level - 1), first + NODE_SIZE);
+                for (size_t child = first; child < last; child++) {
+                    double d = c.level == 1 ? items[child].distanceSquared(x, y)
+                                            : boxes[levelStart[c.level - 1] + child].distanceSquared(x, y);
+                    queue.push({d, c.level - 1, child});
+                }
+            }
+        }
+        return result;
+    }
+};
+
+// 6.5 Polymorphism Example
 void polymorphismExample() {
     cout << "\n=== POLYMORPHISM ===" << endl;
     
@@ -515,6 +1263,21 @@ void polymorphismExample() {
         shape->display();
         cout << "Area: " << shape->area() << endl;
     }
+    
+    // Same circles plus a rectangle, stored as plain arrays
+    ShapeStore store;
+    store.addCircle(5.0);
+    store.addCircle(3.0);
+    store.addRectangle(5.0, 3.0);
+    cout << "ShapeStore total area of " << store.size() << " shapes: "
+         << store.totalArea() << endl;
+    
+    // Same shapes again, now with positions
+    SpatialIndex index({PlacedShape::circle(1, 0, 0, 5.0), PlacedShape::circle(2, 20, 0, 3.0),
+                        PlacedShape::rectangle(3, 10, 10, 5.0, 3.0)});
+    cout << "Shapes overlapping [8,12]x[8,12]: " << index.range({8, 8, 12, 12}).size() << endl;
+    auto closest = index.nearest(15, 0, 1);
+    cout << "Nearest to (15, 0): shape " << closest[0].second << " at distance " << closest[0].first << endl;
 }
 
 /*
@@ -523,862 +1286,7027 @@ void polymorphismExample() {
 ===============================================================================
 */
 
-void stlContainers() {
-    cout << "\n=== STL CONTAINERS ===" << endl;
-    
-    // Vector - dynamic array
-    vector<int> vec = {1, 2, 3, 4, 5};
-    vec.push_back(6);
-    cout << "Vector size: " << vec.size() << endl;
-    cout << "Vector elements: ";
-    for (const auto& v : vec) cout << v << " ";
-    cout << endl;
-    
-    // List - doubly linked list
-    list<string> lst = {"apple", "banana", "cherry"};
-    lst.push_front("apricot");
-    cout << "List: ";
-    for (const auto& item : lst) cout << item << " ";
-    cout << endl;
+// 7.1 Flat Hash Map
+// map/set allocate a node per element and chase a pointer per tree level.
+// This table keeps elements in one array (open addressing) plus one control
+// byte per slot: empty, deleted, or 7 bits of the element's hash. A lookup
+// compares 16 control bytes at once and only touches the elements whose
+// byte matches, so most misses never read an element at all (the
+// "Swiss table" design). At most 7/8 of the slots are used.
+template<typename Key>
+struct FlatHash : hash<Key> {};
+
+// Strings hash through string_view, so find("Bob") needs no temporary string
+template<>
+struct FlatHash<string> {
+    using is_transparent = void;
+    size_t operator()(string_view s) const { return hash<string_view>{}(s); }
+};
+
+namespace swiss {
+
+constexpr int8_t EMPTY = -128;
+constexpr int8_t DELETED = -2;
+constexpr size_t GROUP_WIDTH = 16;
+
+// Bit i set for each control byte in a 16-byte window that matches
+struct Group {
+#ifdef __SSE2__
+    __m128i ctrl;
     
-    // Set - ordered unique elements
-    set<int> s = {3, 1, 4, 1, 5, 9};  // Duplicates removed
-    cout << "Set: ";
-    for (const auto& elem : s) cout << elem << " ";
-    cout << endl;
+    explicit Group(const int8_t* p) : ctrl(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p))) {}
     
-    // Map - key-value pairs
-    map<string, int> ages;
-    ages["Alice"] = 30;
-    ages["Bob"] = 25;
-    ages["Charlie"] = 35;
+    uint32_t match(int8_t h2) const {
+        return _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_set1_epi8(h2), ctrl));
+    }
     
-    cout << "Map (ages):" << endl;
-    for (const auto& pair : ages) {
-        cout << pair.first << ": " << pair.second << endl;
+    // EMPTY and DELETED are the only negative values below -1
+    uint32_t matchEmptyOrDeleted() const {
+        return _mm_movemask_epi8(_mm_cmpgt_epi8(_mm_set1_epi8(-1), ctrl));
     }
+#else
+    const int8_t* ctrl;
     
-    // Queue and Stack
-    queue<int> q;
-    stack<int> st;
+    explicit Group(const int8_t* p) : ctrl(p) {}
     
-    for (int i = 1; i <= 3; i++) {
-        q.push(i);
-        st.push(i);
+    uint32_t match(int8_t h2) const {
+        uint32_t mask = 0;
+        for (size_t i = 0; i < GROUP_WIDTH; i++) mask |= uint32_t(ctrl[i] == h2) << i;
+        return mask;
     }
     
-    cout << "Queue (FIFO): ";
-    while (!q.empty()) {
-        cout << q.front() << " ";
-        q.pop();
+    uint32_t matchEmptyOrDeleted() const {
+        uint32_t mask = 0;
+        for (size_t i = 0; i < GROUP_WIDTH; i++) mask |= uint32_t(ctrl[i] < -1) << i;
+        return mask;
     }
-    cout << endl;
+#endif
     
-    cout << "Stack (LIFO): ";
-    while (!st.empty()) {
-        cout << st.top() << " ";
-        st.pop();
-    }
-    cout << endl;
+    uint32_t matchEmpty() const { return match(EMPTY); }
+};
+
+// Spreads weak hashes (std::hash<int> is the identity) over all 64 bits
+inline size_t mix(size_t h) {
+#if defined(__SIZEOF_INT128__)
+    unsigned __int128 m = static_cast<unsigned __int128>(h) * 0x9E3779B97F4A7C15ull;
+    return static_cast<size_t>(m) ^ static_cast<size_t>(m >> 64);
+#else
+    h ^= h >> 33;
+    h *= 0xFF51AFD7ED558CCDull;
+    return h ^ (h >> 33);
+#endif
 }
 
-/*
-===============================================================================
-                            8. STL ALGORITHMS
-===============================================================================
-*/
-
-void stlAlgorithms() {
-    cout << "\n=== STL ALGORITHMS ===" << endl;
+// Shared by FlatHashMap and FlatHashSet; Policy says what a slot holds and
+// how to get its key
+template<typename Policy, typename Hash, typename Equal>
+class Table {
+public:
+    using key_type = typename Policy::key_type;
+    using value_type = typename Policy::slot_type;
     
-    vector<int> numbers = {64, 34, 25, 12, 22, 11, 90};
+private:
+    int8_t* ctrl = nullptr;            // capacity + GROUP_WIDTH - 1 bytes; the tail mirrors the head
+    value_type* slots = nullptr;
+    size_t capacity = 0;               // 0 or a power of two >= GROUP_WIDTH
+    size_t count = 0;
+    size_t growthLeft = 0;             // EMPTY slots we may still fill before rehashing
+    [[no_unique_address]] Hash hasher;
+    [[no_unique_address]] Equal equal;
+    
+    static size_t maxLoad(size_t cap) { return cap - cap / 8; }
+    
+    // Smallest valid capacity that holds n elements
+    static size_t capacityFor(size_t n) {
+        size_t cap = GROUP_WIDTH;
+        while (maxLoad(cap) < n) cap *= 2;
+        return cap;
+    }
     
-    // Sort
-    sort(numbers.begin(), numbers.end());
-    cout << "Sorted: ";
-    for (const auto& n : numbers) cout << n << " ";
-    cout << endl;
+    template<typename Q>
+    static constexpr bool canLookUp = is_convertible_v<const Q&, const key_type&> ||
+        requires { typename Hash::is_transparent; };
     
-    // Find
-    auto it = find(numbers.begin(), numbers.end(), 25);
-    if (it != numbers.end()) {
-        cout << "Found 25 at position: " << distance(numbers.begin(), it) << endl;
+    void setCtrl(size_t i, int8_t value) {
+        ctrl[i] = value;
+        if (i < GROUP_WIDTH - 1) ctrl[capacity + i] = value;
     }
     
-    // Binary search (requires sorted container)
-    bool found = binary_search(numbers.begin(), numbers.end(), 22);
-    cout << "22 exists: " << boolalpha << found << endl;
+    // First EMPTY or DELETED slot on the probe sequence of hash h
+    size_t findFirstNonFull(size_t h) const {
+        size_t mask = capacity - 1;
+        size_t pos = (h >> 7) & mask;
+        for (size_t step = GROUP_WIDTH;; step += GROUP_WIDTH) {
+            uint32_t free = Group(ctrl + pos).matchEmptyOrDeleted();
+            if (free != 0) return (pos + countr_zero(free)) & mask;
+            pos = (pos + step) & mask;
+        }
+    }
     
-    // Count
-    vector<int> data = {1, 2, 2, 3, 2, 4, 2};
-    int count = count(data.begin(), data.end(), 2);
-    cout << "Count of 2s: " << count << endl;
+    void allocate(size_t cap) {
+        capacity = cap;
+        ctrl = new int8_t[cap + GROUP_WIDTH - 1];
+        memset(ctrl, EMPTY, cap + GROUP_WIDTH - 1);
+        slots = allocator<value_type>().allocate(cap);
+        growthLeft = maxLoad(cap) - count;
+    }
     
-    // Transform
-    vector<int> squared(data.size());
-    transform(data.begin(), data.end(), squared.begin(), 
-              [](int x) { return x * x; });
-    cout << "Squared: ";
-    for (const auto& n : squared) cout << n << " ";
-    cout << endl;
+    void destroyAll() {
+        for (size_t i = 0; i < capacity; i++) {
+            if (ctrl[i] >= 0) destroy_at(&slots[i]);
+        }
+    }
     
-    // Accumulate (sum)
-    int sum = accumulate(numbers.begin(), numbers.end(), 0);
-    cout << "Sum: " << sum << endl;
-}
-
-/*
-===============================================================================
-                            9. TEMPLATES
-===============================================================================
-*/
-
-// 9.1 Function Templates
-template<typename T>
-T maximum(T a, T b) {
-    return (a > b) ? a : b;
-}
-
-// Function template specialization
-template<>
-const char* maximum<const char*>(const char* a, const char* b) {
-    return (strcmp(a, b) > 0) ? a : b;
-}
-
-// 9.2 Class Templates
-template<typename T>
-class Stack {
-private:
-    vector<T> elements;
+    void deallocate() {
+        if (capacity == 0) return;
+        delete[] ctrl;
+        allocator<value_type>().deallocate(slots, capacity);
+        ctrl = nullptr;
+        slots = nullptr;
+        capacity = 0;
+        growthLeft = 0;
+    }
     
-public:
-    void push(const T& element) {
-        elements.push_back(element);
+    void resize(size_t newCapacity) {
+        int8_t* oldCtrl = ctrl;
+        value_type* oldSlots = slots;
+        size_t oldCapacity = capacity;
+        allocate(newCapacity);
+        for (size_t i = 0; i < oldCapacity; i++) {
+            if (oldCtrl[i] < 0) continue;
+            size_t h = mix(hasher(Policy::key(oldSlots[i])));
+            size_t target = findFirstNonFull(h);
+            setCtrl(target, static_cast<int8_t>(h & 0x7F));
+            construct_at(&slots[target], move(oldSlots[i]));
+            destroy_at(&oldSlots[i]);
+        }
+        growthLeft = maxLoad(capacity) - count;
+        if (oldCapacity != 0) {
+            delete[] oldCtrl;
+            allocator<value_type>().deallocate(oldSlots, oldCapacity);
+        }
     }
     
-    void pop() {
-        if (elements.empty()) {
-            throw runtime_error("Stack is empty");
+    // Out of EMPTY slots: mostly tombstones means clean up in place, else grow
+    void rehashForGrowth() {
+        if (capacity == 0) resize(GROUP_WIDTH);
+        else if (count <= maxLoad(capacity) / 2) resize(capacity);
+        else resize(capacity * 2);
+    }
+    
+protected:
+    template<typename Q>
+    size_t findIndex(const Q& key) const {
+        if (count == 0) return capacity;
+        return findIndex(key, mix(hasher(key)));
+    }
+    
+    template<typename Q>
+    size_t findIndex(const Q& key, size_t h) const {
+        int8_t h2 = static_cast<int8_t>(h & 0x7F);
+        size_t mask = capacity - 1;
+        size_t pos = (h >> 7) & mask;
+        for (size_t step = GROUP_WIDTH;; step += GROUP_WIDTH) {
+            Group group(ctrl + pos);
+            for (uint32_t m = group.match(h2); m != 0; m &= m - 1) {
+                size_t i = (pos + countr_zero(m)) & mask;
+                if (equal(Policy::key(slots[i]), key)) return i;
+            }
+            if (group.matchEmpty() != 0) return capacity;
+            pos = (pos + step) & mask;
         }
-        elements.pop_back();
     }
     
-    T top() const {
-        if (elements.empty()) {
-            throw runtime_error("Stack is empty");
+    // {slot, true} if the caller must construct the element in that slot
+    template<typename Q>
+    pair<size_t, bool> findOrPrepareInsert(const Q& key) {
+        size_t h = mix(hasher(key));
+        if (count != 0) {
+            size_t found = findIndex(key, h);
+            if (found != capacity) return {found, false};
         }
-        return elements.back();
+        
+        if (capacity == 0) rehashForGrowth();
+        size_t target = findFirstNonFull(h);
+        if (ctrl[target] == EMPTY && growthLeft == 0) {
+            rehashForGrowth();
+            target = findFirstNonFull(h);
+        }
+        if (ctrl[target] == EMPTY) growthLeft--;
+        setCtrl(target, static_cast<int8_t>(h & 0x7F));
+        count++;
+        return {target, true};
     }
     
-    bool empty() const {
-        return elements.empty();
+    // True when the next new element may trigger a rehash, which moves every
+    // element: arguments that refer into the table must be copied out first
+    bool insertMayRehash() const { return growthLeft == 0; }
+    
+    // Undoes findOrPrepareInsert when constructing the element threw
+    void abandonSlot(size_t i) {
+        setCtrl(i, DELETED);
+        count--;
     }
     
-    size_t size() const {
-        return elements.size();
+    value_type& slotAt(size_t i) { return slots[i]; }
+    const value_type& slotAt(size_t i) const { return slots[i]; }
+    
+public:
+    template<bool Const>
+    class Iterator {
+    private:
+        using TablePtr = conditional_t<Const, const Table*, Table*>;
+        TablePtr table = nullptr;
+        size_t index = 0;
+        
+        // Jumps over free slots a group at a time; mirrored tail bytes past
+        // the end only ever move index to capacity
+        void skipFree() {
+            while (index < table->capacity && table->ctrl[index] < 0) {
+                uint32_t full = ~Group(table->ctrl + index).matchEmptyOrDeleted() & 0xFFFF;
+                size_t next = full != 0 ? index + countr_zero(full) : index + GROUP_WIDTH;
+                index = min(next, table->capacity);
+            }
+        }
+        
+        friend class Table;
+        
+    public:
+        using iterator_category = forward_iterator_tag;
+        using value_type = typename Table::value_type;
+        using difference_type = ptrdiff_t;
+        using reference = conditional_t<Const, const value_type&, value_type&>;
+        using pointer = conditional_t<Const, const value_type*, value_type*>;
+        
+        Iterator() = default;
+        Iterator(TablePtr t, size_t i, bool skip = true) : table(t), index(i) {
+            if (skip) skipFree();
+        }
+        
+        // iterator converts to const_iterator
+        operator Iterator<true>() const { return Iterator<true>(table, index, false); }
+        
+        reference operator*() const { return table->slots[index]; }
+        pointer operator->() const { return &table->slots[index]; }
+        
+        Iterator& operator++() {
+            index++;
+            skipFree();
+            return *this;
+        }
+        
+        Iterator operator++(int) {
+            Iterator old = *this;
+            ++*this;
+            return old;
+        }
+        
+        bool operator==(const Iterator& other) const { return index == other.index; }
+    };
+    
+    using iterator = Iterator<false>;
+    using const_iterator = Iterator<true>;
+    
+    Table() = default;
+    
+    Table(const Table& other) : hasher(other.hasher), equal(other.equal) {
+        reserve(other.count);
+        for (const auto& value : other) {
+            auto [i, inserted] = findOrPrepareInsert(Policy::key(value));
+            construct_at(&slots[i], value);
+        }
     }
-};
-
-void templateExamples() {
-    cout << "\n=== TEMPLATES ===" << endl;
     
-    // Function templates
-    cout << "Max of 10, 20: " << maximum(10, 20) << endl;
-    cout << "Max of 3.14, 2.71: " << maximum(3.14, 2.71) << endl;
-    cout << "Max of strings: " << maximum(string("apple"), string("banana")) << endl;
+    Table(Table&& other) noexcept
+        : ctrl(exchange(other.ctrl, nullptr)), slots(exchange(other.slots, nullptr)),
+          capacity(exchange(other.capacity, 0)), count(exchange(other.count, 0)),
+          growthLeft(exchange(other.growthLeft, 0)), hasher(other.hasher), equal(other.equal) {}
+    
+    Table& operator=(Table other) noexcept {
+        swap(ctrl, other.ctrl);
+        swap(slots, other.slots);
+        swap(capacity, other.capacity);
+        swap(count, other.count);
+        swap(growthLeft, other.growthLeft);
+        swap(hasher, other.hasher);
+        swap(equal, other.equal);
+        return *this;
+    }
     
-    // Class templates
-    Stack<int> intStack;
-    intStack.push(1);
-    intStack.push(2);
-    intStack.push(3);
+    ~Table() {
+        destroyAll();
+        deallocate();
+    }
     
-    cout << "Stack size: " << intStack.size() << endl;
-    cout << "Top element: " << intStack.top() << endl;
+    iterator begin() { return iterator(this, 0); }
+    iterator end() { return iterator(this, capacity, false); }
+    const_iterator begin() const { return const_iterator(this, 0); }
+    const_iterator end() const { return const_iterator(this, capacity, false); }
     
-    Stack<string> stringStack;
-    stringStack.push("Hello");
-    stringStack.push("World");
-    cout << "String stack top: " << stringStack.top() << endl;
-}
+    size_t size() const { return count; }
+    bool empty() const { return count == 0; }
+    size_t bucketCount() const { return capacity; }
+    double loadFactor() const { return capacity == 0 ? 0.0 : double(count) / capacity; }
+    
+    // Room for n elements without rehashing
+    void reserve(size_t n) {
+        if (n > count + growthLeft) resize(capacityFor(n));
+    }
+    
+    // Rebuilds with capacity for max(n, size()) elements; may shrink, drops tombstones
+    void rehash(size_t n) {
+        size_t target = capacityFor(max(n, count));
+        if (count == 0 && n == 0) {
+            deallocate();
+        } else {
+            resize(target);
+        }
+    }
+    
+    void clear() {
+        destroyAll();
+        if (capacity != 0) {
+            memset(ctrl, EMPTY, capacity + GROUP_WIDTH - 1);
+        }
+        count = 0;
+        growthLeft = capacity == 0 ? 0 : maxLoad(capacity);
+    }
+    
+    template<typename Q> requires canLookUp<Q>
+    iterator find(const Q& key) { return iterator(this, findIndex(key), false); }
+    
+    template<typename Q> requires canLookUp<Q>
+    const_iterator find(const Q& key) const { return const_iterator(this, findIndex(key), false); }
+    
+    template<typename Q> requires canLookUp<Q>
+    bool contains(const Q& key) const { return findIndex(key) != capacity; }
+    
+    void erase(const_iterator it) {
+        destroy_at(&slots[it.index]);
+        setCtrl(it.index, DELETED);
+        count--;
+    }
+    
+    template<typename Q> requires canLookUp<Q>
+    size_t erase(const Q& key) {
+        size_t i = findIndex(key);
+        if (i == capacity) return 0;
+        erase(const_iterator(this, i, false));
+        return 1;
+    }
+};
 
-/*
-===============================================================================
-                            10. EXCEPTION HANDLING
-===============================================================================
-*/
+template<typename K, typename V>
+struct MapPolicy {
+    using key_type = K;
+    using slot_type = pair<K, V>;
+    static const K& key(const slot_type& slot) { return slot.first; }
+};
 
-class CustomException : public exception {
+template<typename K>
+struct SetPolicy {
+    using key_type = K;
+    using slot_type = K;
+    static const K& key(const slot_type& slot) { return slot; }
+};
+
+}  // namespace swiss
+
+// Iterators yield pair<K, V>&; changing a key through one corrupts the table
+template<typename K, typename V, typename Hash = FlatHash<K>, typename Equal = equal_to<>>
+class FlatHashMap : public swiss::Table<swiss::MapPolicy<K, V>, Hash, Equal> {
 private:
-    string message;
+    using Base = swiss::Table<swiss::MapPolicy<K, V>, Hash, Equal>;
     
 public:
-    CustomException(const string& msg) : message(msg) {}
+    using typename Base::iterator;
+    using Base::Base;
     
-    const char* what() const noexcept override {
-        return message.c_str();
+    FlatHashMap() = default;
+    
+    FlatHashMap(initializer_list<pair<K, V>> init) {
+        this->reserve(init.size());
+        for (const auto& entry : init) insert(entry);
     }
-};
-
-void riskyFunction(int value) {
-    if (value < 0) {
-        throw invalid_argument("Value cannot be negative");
+    
+    // Constructs the value only if the key is new. The key and arguments may
+    // refer to elements of this map (m[m.begin()->first]), like std::unordered_map.
+    template<typename Q, typename... Args>
+    pair<iterator, bool> try_emplace(Q&& key, Args&&... args) {
+        if (this->insertMayRehash()) {
+            size_t found = this->findIndex(key);
+            if (found != this->bucketCount()) return {iterator(this, found, false), false};
+            // Build the entry before the rehash can move what the arguments point at
+            pair<K, V> entry(piecewise_construct, forward_as_tuple(forward<Q>(key)),
+                             forward_as_tuple(forward<Args>(args)...));
+            size_t i = this->findOrPrepareInsert(entry.first).first;
+            try {
+                construct_at(&this->slotAt(i), move(entry));
+            } catch (...) {
+                this->abandonSlot(i);
+                throw;
+            }
+            return {iterator(this, i, false), true};
+        }
+        auto [i, isNew] = this->findOrPrepareInsert(key);
+        if (isNew) {
+            try {
+                construct_at(&this->slotAt(i), piecewise_construct,
+                             forward_as_tuple(forward<Q>(key)), forward_as_tuple(forward<Args>(args)...));
+            } catch (...) {
+                this->abandonSlot(i);
+                throw;
+            }
+        }
+        return {iterator(this, i, false), isNew};
     }
-    if (value == 0) {
-        throw CustomException("Custom error: Value is zero");
+    
+    pair<iterator, bool> insert(const pair<K, V>& entry) { return try_emplace(entry.first, entry.second); }
+    pair<iterator, bool> insert(pair<K, V>&& entry) { return try_emplace(move(entry.first), move(entry.second)); }
+    
+    template<typename Q>
+    V& operator[](Q&& key) { return try_emplace(forward<Q>(key)).first->second; }
+    
+    template<typename Q>
+    V& at(const Q& key) {
+        auto it = this->find(key);
+        if (it == this->end()) throw runtime_error("FlatHashMap::at: key not found");
+        return it->second;
     }
-    cout << "Value is: " << value << endl;
-}
+    
+    template<typename Q>
+    const V& at(const Q& key) const {
+        auto it = this->find(key);
+        if (it == this->end()) throw runtime_error("FlatHashMap::at: key not found");
+        return it->second;
+    }
+};
 
-void exceptionHandling() {
-    cout << "\n=== EXCEPTION HANDLING ===" << endl;
+template<typename K, typename Hash = FlatHash<K>, typename Equal = equal_to<>>
+class FlatHashSet : public swiss::Table<swiss::SetPolicy<K>, Hash, Equal> {
+private:
+    using Base = swiss::Table<swiss::SetPolicy<K>, Hash, Equal>;
     
-    vector<int> testValues = {5, -1, 0, 10};
+public:
+    using typename Base::const_iterator;
+    using Base::Base;
     
-    for (int val : testValues) {
-        try {
-            riskyFunction(val);
-        }
-        catch (const invalid_argument& e) {
-            cout << "Invalid argument: " << e.what() << endl;
-        }
-        catch (const CustomException& e) {
-            cout << "Custom exception: " << e.what() << endl;
-        }
-        catch (const exception& e) {
-            cout << "Generic exception: " << e.what() << endl;
-        }
-        catch (...) {
-            cout << "Unknown exception caught" << endl;
+    FlatHashSet() = default;
+    
+    FlatHashSet(initializer_list<K> init) {
+        this->reserve(init.size());
+        for (const auto& key : init) insert(key);
+    }
+    
+    // Elements are read-only, as in std::set
+    const_iterator begin() const { return Base::begin(); }
+    const_iterator end() const { return Base::end(); }
+    
+    template<typename Q>
+    pair<const_iterator, bool> insert(Q&& key) {
+        if (this->insertMayRehash()) {
+            size_t found = this->findIndex(key);
+            if (found != this->bucketCount()) return {const_iterator(this, found, false), false};
+            // The key may be an element of this set; copy it before the rehash
+            K local(forward<Q>(key));
+            return insertUnchecked(move(local));
         }
+        return insertUnchecked(forward<Q>(key));
     }
     
-    // RAII example with smart pointers (automatic cleanup)
-    try {
-        unique_ptr<int[]> arr(new int[1000]);
-        // Even if exception occurs, memory is automatically freed
-        throw runtime_error("Something went wrong");
+private:
+    template<typename Q>
+    pair<const_iterator, bool> insertUnchecked(Q&& key) {
+        auto [i, isNew] = this->findOrPrepareInsert(key);
+        if (isNew) {
+            try {
+                construct_at(&this->slotAt(i), forward<Q>(key));
+            } catch (...) {
+                this->abandonSlot(i);
+                throw;
+            }
+        }
+        return {const_iterator(this, i, false), isNew};
     }
-    catch (const exception& e) {
-        cout << "Caught: " << e.what() << " (memory still cleaned up)" << endl;
+};
+
+// 7.2 Sorted Flat Map
+// For data that is built once and then only read, a sorted array beats a
+// tree: keys sit next to each other, so a lookup touches a few cache lines
+// and a full walk is a plain array scan. Keys and values are kept in
+// separate vectors so the search only streams through keys. Inserting or
+// erasing one element shifts the rest (O(n)); build in bulk instead.
+
+// Index of the first element not less than key. The loop has no
+// data-dependent branch: the compiler turns the step into a conditional
+// move, so nothing is mispredicted.
+template<typename T, typename Q, typename Compare>
+size_t branchlessLowerBound(const T* data, size_t n, const Q& key, Compare comp) {
+    if (n == 0) return 0;
+    const T* base = data;
+    while (n > 1) {
+        size_t half = n / 2;
+        base = comp(base[half - 1], key) ? base + half : base;
+        n -= half;
     }
+    return (base - data) + comp(*base, key);
 }
 
-/*
-===============================================================================
-                            11. SMART POINTERS (C++11)
-===============================================================================
-*/
-
-class Resource {
+template<typename K, typename Compare = less<>>
+class FlatSet {
+private:
+    vector<K> keys;
+    [[no_unique_address]] Compare comp;
+    
+    template<typename Q>
+    size_t lowerIndex(const Q& key) const {
+        return branchlessLowerBound(keys.data(), keys.size(), key, comp);
+    }
+    
+    template<typename Q>
+    bool matches(size_t i, const Q& key) const {
+        return i < keys.size() && !comp(key, keys[i]);
+    }
+    
 public:
-    Resource(const string& name) : name_(name) {
-        cout << "Resource " << name_ << " created" << endl;
+    using const_iterator = typename vector<K>::const_iterator;
+    
+    FlatSet() = default;
+    FlatSet(initializer_list<K> init) : FlatSet(fromUnsorted(vector<K>(init))) {}
+    
+    // Sorts and removes duplicates once
+    static FlatSet fromUnsorted(vector<K> values) {
+        FlatSet set;
+        sort(values.begin(), values.end(), set.comp);
+        auto same = [&](const K& a, const K& b) { return !set.comp(a, b) && !set.comp(b, a); };
+        values.erase(unique(values.begin(), values.end(), same), values.end());
+        set.keys = move(values);
+        return set;
     }
     
-    ~Resource() {
-        cout << "Resource " << name_ << " destroyed" << endl;
+    const_iterator begin() const { return keys.begin(); }
+    const_iterator end() const { return keys.end(); }
+    size_t size() const { return keys.size(); }
+    bool empty() const { return keys.empty(); }
+    span<const K> values() const { return keys; }
+    
+    template<typename Q>
+    const_iterator lower_bound(const Q& key) const { return keys.begin() + lowerIndex(key); }
+    
+    template<typename Q>
+    const_iterator find(const Q& key) const {
+        size_t i = lowerIndex(key);
+        return matches(i, key) ? keys.begin() + i : keys.end();
     }
     
-    void use() {
-        cout << "Using resource " << name_ << endl;
+    template<typename Q>
+    bool contains(const Q& key) const { return matches(lowerIndex(key), key); }
+    
+    // O(n); false if already present
+    bool insert(const K& key) {
+        size_t i = lowerIndex(key);
+        if (matches(i, key)) return false;
+        keys.insert(keys.begin() + i, key);
+        return true;
     }
     
-private:
-    string name_;
+    template<typename Q>
+    size_t erase(const Q& key) {
+        size_t i = lowerIndex(key);
+        if (!matches(i, key)) return 0;
+        keys.erase(keys.begin() + i);
+        return 1;
+    }
+    
+    void reserve(size_t n) { keys.reserve(n); }
+    void shrinkToFit() { keys.shrink_to_fit(); }
 };
 
-void smartPointers() {
-    cout << "\n=== SMART POINTERS ===" << endl;
+template<typename K, typename V, typename Compare = less<>>
+class FlatMap {
+private:
+    vector<K> keyData;
+    vector<V> valueData;
+    [[no_unique_address]] Compare comp;
     
-    // unique_ptr - exclusive ownership
-    {
-        unique_ptr<Resource> res1 = make_unique<Resource>("A");
-        res1->use();
-        
-        // Transfer ownership
-        unique_ptr<Resource> res2 = move(res1);
-        if (!res1) {
-            cout << "res1 is now empty" << endl;
-        }
-        res2->use();
-    } // res2 automatically destroyed here
+    template<typename Q>
+    size_t lowerIndex(const Q& key) const {
+        return branchlessLowerBound(keyData.data(), keyData.size(), key, comp);
+    }
     
-    // shared_ptr - shared ownership
-    {
-        shared_ptr<Resource> res1 = make_shared<Resource>("B");
-        cout << "Reference count: " << res1.use_count() << endl;
+    template<typename Q>
+    bool matches(size_t i, const Q& key) const {
+        return i < keyData.size() && !comp(key, keyData[i]);
+    }
+    
+public:
+    // Yields {key, value} reference pairs by position
+    template<bool Const>
+    class Iterator {
+    private:
+        using MapPtr = conditional_t<Const, const FlatMap*, FlatMap*>;
+        using ValueRef = conditional_t<Const, const V&, V&>;
+        MapPtr map = nullptr;
+        size_t index = 0;
         
-        {
-            shared_ptr<Resource> res2 = res1;  // Shared ownership
-            cout << "Reference count: " << res1.use_count() << endl;
-            res2->use();
-        } // res2 goes out of scope, but resource not destroyed
+    public:
+        using iterator_category = forward_iterator_tag;
+        using value_type = pair<K, V>;
+        using difference_type = ptrdiff_t;
+        using reference = pair<const K&, ValueRef>;
         
-        cout << "Reference count after res2 destroyed: " << res1.use_count() << endl;
-        res1->use();
-    } // Now resource is destroyed
-    
-    // weak_ptr - non-owning observer
-    weak_ptr<Resource> weak;
-    {
-        shared_ptr<Resource> shared = make_shared<Resource>("C");
-        weak = shared;
+        // Lets it->first / it->second work on a pair built on the fly
+        struct Arrow {
+            reference entry;
+            const reference* operator->() const { return &entry; }
+        };
         
-        if (auto locked = weak.lock()) {
-            locked->use();
+        Iterator() = default;
+        Iterator(MapPtr m, size_t i) : map(m), index(i) {}
+        
+        reference operator*() const { return {map->keyData[index], map->valueData[index]}; }
+        Arrow operator->() const { return {**this}; }
+        
+        Iterator& operator++() {
+            index++;
+            return *this;
         }
-    } // shared goes out of scope, resource destroyed
+        
+        Iterator operator++(int) {
+            Iterator old = *this;
+            index++;
+            return old;
+        }
+        
+        bool operator==(const Iterator& other) const { return index == other.index; }
+    };
+    
+    using iterator = Iterator<false>;
+    using const_iterator = Iterator<true>;
+    
+    FlatMap() = default;
+    FlatMap(initializer_list<pair<K, V>> init) : FlatMap(fromUnsorted(vector<pair<K, V>>(init))) {}
+    
+    // Sorts by key once; for duplicate keys the first entry wins
+    static FlatMap fromUnsorted(vector<pair<K, V>> entries) {
+        FlatMap map;
+        stable_sort(entries.begin(), entries.end(),
+                    [&](const auto& a, const auto& b) { return map.comp(a.first, b.first); });
+        map.keyData.reserve(entries.size());
+        map.valueData.reserve(entries.size());
+        for (auto& [key, value] : entries) {
+            if (!map.keyData.empty() && !map.comp(map.keyData.back(), key)) continue;
+            map.keyData.push_back(move(key));
+            map.valueData.push_back(move(value));
+        }
+        return map;
+    }
     
-    if (weak.expired()) {
-        cout << "Weak pointer expired" << endl;
+    iterator begin() { return {this, 0}; }
+    iterator end() { return {this, keyData.size()}; }
+    const_iterator begin() const { return {this, 0}; }
+    const_iterator end() const { return {this, keyData.size()}; }
+    
+    size_t size() const { return keyData.size(); }
+    bool empty() const { return keyData.empty(); }
+    
+    // Column access: walking these is exactly a vector walk
+    span<const K> keys() const { return keyData; }
+    span<V> values() { return valueData; }
+    span<const V> values() const { return valueData; }
+    
+    template<typename Q>
+    iterator find(const Q& key) {
+        size_t i = lowerIndex(key);
+        return {this, matches(i, key) ? i : keyData.size()};
     }
-}
-
-/*
-===============================================================================
-                            12. FILE I/O
-===============================================================================
-*/
-
-void fileIO() {
-    cout << "\n=== FILE I/O ===" << endl;
     
-    // Write to file
-    ofstream outFile("example.txt");
-    if (outFile.is_open()) {
-        outFile << "Hello, File I/O!" << endl;
-        outFile << "Line 2" << endl;
-        outFile << "Numbers: ";
-        for (int i = 1; i <= 5; i++) {
-            outFile << i << " ";
-        }
-        outFile << endl;
-        outFile.close();
-        cout << "Data written to file" << endl;
+    template<typename Q>
+    const_iterator find(const Q& key) const {
+        size_t i = lowerIndex(key);
+        return {this, matches(i, key) ? i : keyData.size()};
     }
     
-    // Read from file
-    ifstream inFile("example.txt");
-    if (inFile.is_open()) {
-        string line;
-        cout << "Reading from file:" << endl;
-        while (getline(inFile, line)) {
-            cout << line << endl;
-        }
-        inFile.close();
+    template<typename Q>
+    bool contains(const Q& key) const { return matches(lowerIndex(key), key); }
+    
+    // Null if absent; cheaper than find() when only the value is wanted
+    template<typename Q>
+    const V* lookup(const Q& key) const {
+        size_t i = lowerIndex(key);
+        return matches(i, key) ? &valueData[i] : nullptr;
     }
     
-    // Binary file operations
-    ofstream binFile("data.bin", ios::binary);
-    if (binFile.is_open()) {
-        int numbers[] = {1, 2, 3, 4, 5};
-        binFile.write(reinterpret_cast<const char*>(numbers), sizeof(numbers));
-        binFile.close();
+    template<typename Q>
+    const V& at(const Q& key) const {
+        const V* value = lookup(key);
+        if (value == nullptr) throw runtime_error("FlatMap::at: key not found");
+        return *value;
     }
     
-    ifstream binRead("data.bin", ios::binary);
-    if (binRead.is_open()) {
-        int readNumbers[5];
-        binRead.read(reinterpret_cast<char*>(readNumbers), sizeof(readNumbers));
-        cout << "Binary data read: ";
-        for (int i = 0; i < 5; i++) {
-            cout << readNumbers[i] << " ";
+    // O(n) when the key is new
+    V& operator[](const K& key) {
+        size_t i = lowerIndex(key);
+        if (!matches(i, key)) {
+            keyData.insert(keyData.begin() + i, key);
+            valueData.insert(valueData.begin() + i, V());
         }
-        cout << endl;
-        binRead.close();
+        return valueData[i];
     }
     
-    // String streams
-    stringstream ss;
-    ss << "Age: " << 25 << ", Score: " << 98.5;
-    cout << "String stream: " << ss.str() << endl;
-    
-    // Parse from string stream
-    stringstream parseStream("42 3.14 Hello");
-    int intVal;
-    double doubleVal;
-    string stringVal;
-    parseStream >> intVal >> doubleVal >> stringVal;
-    cout << "Parsed: " << intVal << ", " << doubleVal << ", " << stringVal << endl;
-}
-
-/*
-===============================================================================
-                            13. MULTITHREADING (C++11)
-===============================================================================
-*/
-
-void workerFunction(int id) {
-    for (int i = 0; i < 3; i++) {
-        cout << "Worker " << id << " working... step " << i + 1 << endl;
-        this_thread::sleep_for(chrono::milliseconds(500));
+    template<typename Q>
+    size_t erase(const Q& key) {
+        size_t i = lowerIndex(key);
+        if (!matches(i, key)) return 0;
+        keyData.erase(keyData.begin() + i);
+        valueData.erase(valueData.begin() + i);
+        return 1;
     }
-    cout << "Worker " << id << " finished" << endl;
-}
-
-mutex mtx;
-int sharedCounter = 0;
+};
 
-void incrementCounter(int id) {
-    for (int i = 0; i < 1000; i++) {
-        lock_guard<mutex> lock(mtx);  // Automatic lock/unlock
-        sharedCounter++;
-    }
-    cout << "Thread " << id << " finished incrementing" << endl;
-}
+// 7.3 Segmented List
+// A doubly linked list of fixed-size chunks, each holding up to N elements
+// side by side. Walking it touches one node per N elements instead of one
+// per element, and push/pop at either end is O(1) without moving anything,
+// so references and iterators stay valid across pushes. insert()/erase()
+// in the middle only shift elements inside one chunk (a full chunk is split
+// in two), so other chunks are untouched; erase() also folds a chunk into
+// the next one once both fit in half a chunk.
+// Emptied chunks go to a free list and are reused before asking the heap.
 
-int calculateSquare(int x) {
-    this_thread::sleep_for(chrono::milliseconds(1000));
-    return x * x;
+// Roughly 1 KB of elements per chunk, but never fewer than 8
+template<typename T>
+constexpr size_t segmentedChunkSize() {
+    return max<size_t>(8, 1024 / sizeof(T));
 }
 
-void multithreading() {
-    cout << "\n=== MULTITHREADING ===" << endl;
+template<typename T, size_t N = segmentedChunkSize<T>()>
+class SegmentedList {
+    static_assert(N >= 2 && N <= numeric_limits<uint32_t>::max(), "chunk size out of range");
     
-    // Basic thread creation
-    thread t1(workerFunction, 1);
-    thread t2(workerFunction, 2);
+private:
+    struct Chunk {
+        Chunk* prev = nullptr;
+        Chunk* next = nullptr;
+        uint32_t first = 0;     // Live elements are slots [first, last)
+        uint32_t last = 0;
+        alignas(T) unsigned char storage[N * sizeof(T)];
+        
+        T* slots() { return reinterpret_cast<T*>(storage); }
+        size_t count() const { return last - first; }
+    };
+    
+    Chunk* head = nullptr;
+    Chunk* tail = nullptr;
+    Chunk* pool = nullptr;      // Free chunks, linked through next
+    size_t count = 0;
+    size_t chunks = 0;
+    size_t pooled = 0;
+    
+    Chunk* acquireChunk(uint32_t start) {
+        Chunk* c = pool;
+        if (c != nullptr) {
+            pool = c->next;
+            pooled--;
+        } else {
+            c = new Chunk;
+        }
+        c->prev = c->next = nullptr;
+        c->first = c->last = start;
+        chunks++;
+        return c;
+    }
     
-    t1.join();  // Wait for thread to complete
-    t2.join();
+    void releaseChunk(Chunk* c) {
+        c->next = pool;
+        pool = c;
+        pooled++;
+        chunks--;
+    }
     
-    // Thread synchronization with mutex
-    sharedCounter = 0;  // Reset counter
-    thread inc1(incrementCounter, 1);
-    thread inc2(incrementCounter, 2);
+    void linkAfter(Chunk* pos, Chunk* c) {
+        c->prev = pos;
+        c->next = pos != nullptr ? pos->next : head;
+        (c->next != nullptr ? c->next->prev : tail) = c;
+        (pos != nullptr ? pos->next : head) = c;
+    }
     
-    inc1.join();
-    inc2.join();
+    void unlink(Chunk* c) {
+        (c->prev != nullptr ? c->prev->next : head) = c->next;
+        (c->next != nullptr ? c->next->prev : tail) = c->prev;
+    }
     
-    cout << "Final counter value: " << sharedCounter << endl;
+    // Moves slots [from, to) of src into raw slots starting at dst
+    static void relocate(T* src, size_t from, size_t to, T* dst) {
+        for (size_t i = from; i < to; i++) {
+            ::new (dst + (i - from)) T(std::move(src[i]));
+            src[i].~T();
+        }
+    }
     
-    // Async and futures
-    future<int> result = async(launch::async, calculateSquare, 5);
-    cout << "Calculating square asynchronously..." << endl;
+    // Moves the upper half of a full chunk into a new chunk after it
+    void split(Chunk* c) {
+        uint32_t mid = c->first + uint32_t(c->count() / 2);
+        Chunk* upper = acquireChunk(0);
+        relocate(c->slots(), mid, c->last, upper->slots());
+        upper->last = c->last - mid;
+        c->last = mid;
+        linkAfter(c, upper);
+    }
     
-    // Do other work while calculation runs
-    this_thread::sleep_for(chrono::milliseconds(500));
-    cout << "Doing other work..." << endl;
+    // Appends the next chunk's elements to c and frees the next chunk
+    void mergeNext(Chunk* c) {
+        Chunk* next = c->next;
+        if (c->last + next->count() > N) {
+            // Slide to the front first; each target slot is already vacated
+            relocate(c->slots(), c->first, c->last, c->slots());
+            c->last -= c->first;
+            c->first = 0;
+        }
+        relocate(next->slots(), next->first, next->last, c->slots() + c->last);
+        c->last += uint32_t(next->count());
+        unlink(next);
+        releaseChunk(next);
+    }
     
-    // Get result (will wait if not ready)
-    int square = result.get();
-    cout << "Square result: " << square << endl;
+public:
+    // Carries the end of the current chunk so ++ only loads it again on
+    // reaching that end, which picks up elements push_back added meanwhile.
+    // Pushes invalidate only end(), as for deque; pop_front() invalidates
+    // iterators to the popped element, pop_back()/insert()/erase() any of them
+    template<bool Const>
+    class Iterator {
+    private:
+        Chunk* chunk = nullptr;
+        T* cur = nullptr;
+        T* stop = nullptr;
+        
+        uint32_t index() const { return uint32_t(cur - chunk->slots()); }
+        
+        friend class SegmentedList;
+        template<bool> friend class Iterator;
+        
+    public:
+        using iterator_category = bidirectional_iterator_tag;
+        using value_type = T;
+        using difference_type = ptrdiff_t;
+        using reference = conditional_t<Const, const T&, T&>;
+        using pointer = conditional_t<Const, const T*, T*>;
+        
+        Iterator() = default;
+        Iterator(Chunk* c, uint32_t i) : chunk(c), cur(c->slots() + i), stop(c->slots() + c->last) {}
+        
+        // iterator converts to const_iterator
+        operator Iterator<true>() const {
+            Iterator<true> it;
+            it.chunk = chunk;
+            it.cur = cur;
+            it.stop = stop;
+            return it;
+        }
+        
+        reference operator*() const { return *cur; }
+        pointer operator->() const { return cur; }
+        
+        Iterator& operator++() {
+            if (++cur == stop) {
+                stop = chunk->slots() + chunk->last;
+                if (cur == stop && chunk->next != nullptr) {
+                    chunk = chunk->next;
+                    cur = chunk->slots() + chunk->first;
+                    stop = chunk->slots() + chunk->last;
+                }
+            }
+            return *this;
+        }
+        Iterator operator++(int) { Iterator old = *this; ++*this; return old; }
+        
+        Iterator& operator--() {
+            if (cur == chunk->slots() + chunk->first) {
+                chunk = chunk->prev;
+                cur = stop = chunk->slots() + chunk->last;
+            }
+            --cur;
+            return *this;
+        }
+        Iterator operator--(int) { Iterator old = *this; --*this; return old; }
+        
+        bool operator==(const Iterator& other) const { return cur == other.cur; }
+    };
     
-    // Promise and future
-    promise<string> prom;
-    future<string> fut = prom.get_future();
+    using iterator = Iterator<false>;
+    using const_iterator = Iterator<true>;
     
-    thread([&prom]() {
-        this_thread::sleep_for(chrono::milliseconds(1000));
-        prom.set_value("Hello from promise!");
-    }).detach();
+    SegmentedList() = default;
     
-    cout << "Waiting for promise..." << endl;
-    cout << "Promise result: " << fut.get() << endl;
-}
-
-/*
-===============================================================================
-                            14. MODERN C++ FEATURES
-===============================================================================
-*/
-
-// 14.1 Move Semantics and Perfect Forwarding
-class MovableClass {
-private:
-    int* data;
-    size_t size;
+    SegmentedList(initializer_list<T> init) {
+        for (const auto& value : init) push_back(value);
+    }
     
-public:
-    // Constructor
-    MovableClass(size_t s) : size(s), data(new int[s]) {
-        cout << "Constructor: allocated " << size << " elements" << endl;
-        for (size_t i = 0; i < size; i++) {
-            data[i] = static_cast<int>(i);
+    SegmentedList(const SegmentedList& other) {
+        for (const auto& value : other) push_back(value);
+    }
+    
+    SegmentedList(SegmentedList&& other) noexcept
+        : head(exchange(other.head, nullptr)), tail(exchange(other.tail, nullptr)),
+          pool(exchange(other.pool, nullptr)), count(exchange(other.count, 0)),
+          chunks(exchange(other.chunks, 0)), pooled(exchange(other.pooled, 0)) {}
+    
+    SegmentedList& operator=(SegmentedList other) noexcept {
+        swap(other);
+        return *this;
+    }
+    
+    ~SegmentedList() {
+        clear();
+        shrinkToFit();
+    }
+    
+    void swap(SegmentedList& other) noexcept {
+        std::swap(head, other.head);
+        std::swap(tail, other.tail);
+        std::swap(pool, other.pool);
+        std::swap(count, other.count);
+        std::swap(chunks, other.chunks);
+        std::swap(pooled, other.pooled);
+    }
+    
+    size_t size() const { return count; }
+    bool empty() const { return count == 0; }
+    size_t chunkCount() const { return chunks; }
+    size_t pooledChunks() const { return pooled; }
+    static constexpr size_t chunkCapacity() { return N; }
+    
+    iterator begin() { return head != nullptr ? iterator(head, head->first) : iterator(); }
+    iterator end() { return tail != nullptr ? iterator(tail, tail->last) : iterator(); }
+    const_iterator begin() const { return const_cast<SegmentedList*>(this)->begin(); }
+    const_iterator end() const { return const_cast<SegmentedList*>(this)->end(); }
+    
+    T& front() { return head->slots()[head->first]; }
+    T& back() { return tail->slots()[tail->last - 1]; }
+    const T& front() const { return head->slots()[head->first]; }
+    const T& back() const { return tail->slots()[tail->last - 1]; }
+    
+    template<typename... Args>
+    T& emplace_back(Args&&... args) {
+        if (tail == nullptr || tail->last == N) {
+            linkAfter(tail, acquireChunk(0));
         }
+        T* slot = ::new (tail->slots() + tail->last) T(forward<Args>(args)...);
+        tail->last++;
+        count++;
+        return *slot;
     }
     
-    // Copy constructor
-    MovableClass(const MovableClass& other) : size(other.size), data(new int[size]) {
-        cout << "Copy constructor called" << endl;
-        for (size_t i = 0; i < size; i++) {
-            data[i] = other.data[i];
+    template<typename... Args>
+    T& emplace_front(Args&&... args) {
+        if (head == nullptr || head->first == 0) {
+            linkAfter(nullptr, acquireChunk(uint32_t(N)));
         }
+        T* slot = ::new (head->slots() + head->first - 1) T(forward<Args>(args)...);
+        head->first--;
+        count++;
+        return *slot;
     }
     
-    // Move constructor (C++11)
-    MovableClass(MovableClass&& other) noexcept : size(other.size), data(other.data) {
-        cout << "Move constructor called" << endl;
-        other.data = nullptr;
-        other.size = 0;
+    void push_back(const T& value) { emplace_back(value); }
+    void push_back(T&& value) { emplace_back(std::move(value)); }
+    void push_front(const T& value) { emplace_front(value); }
+    void push_front(T&& value) { emplace_front(std::move(value)); }
+    
+    void pop_back() {
+        tail->slots()[--tail->last].~T();
+        count--;
+        if (tail->count() == 0) {
+            Chunk* c = tail;
+            unlink(c);
+            releaseChunk(c);
+        }
     }
     
-    // Copy assignment operator
-    MovableClass& operator=(const MovableClass& other) {
-        cout << "Copy assignment called" << endl;
-        if (this != &other) {
-            delete[] data;
-            size = other.size;
-            data = new int[size];
-            for (size_t i = 0; i < size; i++) {
-                data[i] = other.data[i];
+    void pop_front() {
+        head->slots()[head->first++].~T();
+        count--;
+        if (head->count() == 0) {
+            Chunk* c = head;
+            unlink(c);
+            releaseChunk(c);
+        }
+    }
+    
+    // Inserts before pos; returns an iterator to the new element
+    template<typename... Args>
+    iterator emplace(const_iterator pos, Args&&... args) {
+        Chunk* c = pos.chunk;
+        if (c == nullptr || (c == tail && pos.index() == c->last)) {
+            emplace_back(forward<Args>(args)...);
+            return iterator(tail, tail->last - 1);
+        }
+        // Build the value first: args may alias an element the split moves
+        T value(forward<Args>(args)...);
+        uint32_t i = pos.index();
+        if (c->count() == N) {
+            uint32_t mid = c->first + uint32_t(N / 2);
+            split(c);
+            if (i >= mid) {
+                i -= mid;
+                c = c->next;
             }
         }
-        return *this;
+        T* s = c->slots();
+        // Shift whichever side of the chunk has room and fewer elements to move
+        if (c->first > 0 && (c->last == N || i - c->first < c->last - i)) {
+            if (i == c->first) {
+                ::new (s + i - 1) T(std::move(value));
+            } else {
+                ::new (s + c->first - 1) T(std::move(s[c->first]));
+                std::move(s + c->first + 1, s + i, s + c->first);
+                s[i - 1] = std::move(value);
+            }
+            c->first--;
+            i--;
+        } else {
+            if (i == c->last) {
+                ::new (s + i) T(std::move(value));
+            } else {
+                ::new (s + c->last) T(std::move(s[c->last - 1]));
+                std::move_backward(s + i, s + c->last - 1, s + c->last);
+                s[i] = std::move(value);
+            }
+            c->last++;
+        }
+        count++;
+        return iterator(c, i);
     }
     
-    // Move assignment operator (C++11)
-    MovableClass& operator=(MovableClass&& other) noexcept {
-        cout << "Move assignment called" << endl;
-        if (this != &other) {
-            delete[] data;
-            data = other.data;
-            size = other.size;
-            other.data = nullptr;
-            other.size = 0;
+    iterator insert(const_iterator pos, const T& value) { return emplace(pos, value); }
+    iterator insert(const_iterator pos, T&& value) { return emplace(pos, std::move(value)); }
+    
+    // Returns an iterator to the element after the erased one
+    iterator erase(const_iterator pos) {
+        Chunk* c = pos.chunk;
+        uint32_t i = pos.index();
+        T* s = c->slots();
+        std::move(s + i + 1, s + c->last, s + i);
+        s[--c->last].~T();
+        count--;
+        if (c->count() == 0) {
+            Chunk* next = c->next;
+            unlink(c);
+            releaseChunk(c);
+            return next != nullptr ? iterator(next, next->first) : end();
         }
-        return *this;
+        if (c->next != nullptr && c->count() + c->next->count() <= N / 2) {
+            uint32_t offset = i - c->first;
+            mergeNext(c);
+            i = c->first + offset;
+        }
+        if (i == c->last && c->next != nullptr) {
+            return iterator(c->next, c->next->first);
+        }
+        return iterator(c, i);
     }
     
-    // Destructor
-    ~MovableClass() {
-        delete[] data;
-        cout << "Destructor: freed memory" << endl;
+    // Keeps the chunks in the pool for the next fill
+    void clear() {
+        while (head != nullptr) {
+            Chunk* c = head;
+            for (uint32_t i = c->first; i < c->last; i++) c->slots()[i].~T();
+            unlink(c);
+            releaseChunk(c);
+        }
+        count = 0;
     }
     
-    size_t getSize() const { return size; }
-    int* getData() const { return data; }
+    // Pre-fills the pool so the next n elements need no allocation
+    void reserve(size_t n) {
+        size_t needed = (n + N - 1) / N;
+        while (pooled < needed) {
+            Chunk* c = new Chunk;
+            c->next = pool;
+            pool = c;
+            pooled++;
+        }
+    }
+    
+    // Returns pooled chunks to the heap
+    void shrinkToFit() {
+        while (pool != nullptr) {
+            delete exchange(pool, pool->next);
+        }
+        pooled = 0;
+    }
 };
 
-MovableClass createMovableObject() {
-    return MovableClass(5);  // RVO or move
-}
-
-// Perfect forwarding example
-template<typename T>
-void wrapper(T&& arg) {
-    // Forward arg to another function while preserving its value category
-    processValue(forward<T>(arg));
-}
-
-void processValue(const int& val) {
-    cout << "Processing lvalue: " << val << endl;
-}
-
-void processValue(int&& val) {
-    cout << "Processing rvalue: " << val << endl;
-}
-
-void modernCppFeatures() {
-    cout << "\n=== MODERN C++ FEATURES ===" << endl;
-    
-    // Move semantics
-    cout << "--- Move Semantics ---" << endl;
-    MovableClass obj1(3);
-    MovableClass obj2 = move(obj1);  // Move constructor
-    MovableClass obj3 = createMovableObject();  // Move or RVO
+// 7.4 Priority Queues
+// priority_queue has no way to lower a queued item's priority, so Dijkstra
+// and schedulers push a duplicate and skip stale entries on pop, which
+// grows the heap. IndexedHeap tracks where each handle sits, so
+// decreaseKey() and erase() work in place. It is 4-ary: the tree is half as
+// deep, and keys live apart from ids, so the four children compared on the
+// way down are adjacent keys (32 bytes for uint64_t). Nothing aligns them, so
+// a group can still straddle two cache lines.
+template<typename Priority, typename Compare = less<Priority>>
+class IndexedHeap {
+private:
+    static constexpr size_t ARITY = 4;
+    static constexpr uint32_t NOT_QUEUED = numeric_limits<uint32_t>::max();
+    
+    vector<Priority> keys;      // Heap order; ids[i] is the handle at keys[i]
+    vector<uint32_t> ids;
+    vector<uint32_t> position;  // Handle -> heap index, or NOT_QUEUED
+    [[no_unique_address]] Compare comp;
+    
+    void place(size_t i, Priority&& key, uint32_t id) {
+        keys[i] = std::move(key);
+        ids[i] = id;
+        position[id] = uint32_t(i);
+    }
     
-    // Auto and decltype
-    cout << "\n--- Auto and Decltype ---" << endl;
-    auto x = 42;        // int
-    auto y = 3.14;      // double
-    auto z = "hello";   // const char*
+    // Both sifts carry the moving entry in a hole instead of swapping
+    void siftUp(size_t i, Priority key, uint32_t id) {
+        while (i > 0) {
+            size_t parent = (i - 1) / ARITY;
+            if (!comp(key, keys[parent])) break;
+            place(i, std::move(keys[parent]), ids[parent]);
+            i = parent;
+        }
+        place(i, std::move(key), id);
+    }
     
-    vector<int> vec = {1, 2, 3};
-    auto it = vec.begin();  // vector<int>::iterator
+    void siftDown(size_t i, Priority key, uint32_t id) {
+        size_t n = keys.size();
+        while (true) {
+            size_t first = i * ARITY + 1;
+            if (first >= n) break;
+            size_t best = first;
+            size_t last = min(first + ARITY, n);
+            for (size_t c = first + 1; c < last; c++) {
+                if (comp(keys[c], keys[best])) best = c;
+            }
+            if (!comp(keys[best], key)) break;
+            place(i, std::move(keys[best]), ids[best]);
+            i = best;
+        }
+        place(i, std::move(key), id);
+    }
     
-    decltype(x) another_x = 100;  // int
-    cout << "Auto variables: " << x << ", " << y << endl;
+    // Fills slot i with the last entry and restores the heap around it
+    void refillFromBack(size_t i) {
+        Priority key = std::move(keys.back());
+        uint32_t id = ids.back();
+        keys.pop_back();
+        ids.pop_back();
+        if (i == keys.size()) return;
+        if (i > 0 && comp(key, keys[(i - 1) / ARITY])) siftUp(i, std::move(key), id);
+        else siftDown(i, std::move(key), id);
+    }
     
-    // Range-based for loops (C++11)
-    cout << "\n--- Range-based For ---" << endl;
-    for (const auto& element : vec) {
-        cout << element << " ";
+public:
+    // Handles are small integers (e.g. node or task ids) below `handles`;
+    // push() grows the table when a larger one shows up
+    explicit IndexedHeap(size_t handles = 0) : position(handles, NOT_QUEUED) {}
+    
+    size_t size() const { return keys.size(); }
+    bool empty() const { return keys.empty(); }
+    
+    bool contains(uint32_t id) const {
+        return id < position.size() && position[id] != NOT_QUEUED;
     }
-    cout << endl;
     
-    // Uniform initialization (C++11)
-    cout << "\n--- Uniform Initialization ---" << endl;
-    int a{42};
-    vector<int> numbers{1, 2, 3, 4, 5};
-    map<string, int> ages{"Alice", 30, "Bob", 25};
+    const Priority& priority(uint32_t id) const {
+        if (!contains(id)) throw runtime_error("IndexedHeap: handle not queued");
+        return keys[position[id]];
+    }
     
-    // Initializer lists
-    auto initList = {1, 2, 3, 4, 5};
-    for (auto val : initList) {
-        cout << val << " ";
+    void push(uint32_t id, Priority key) {
+        if (id >= position.size()) position.resize(size_t(id) + 1, NOT_QUEUED);
+        if (position[id] != NOT_QUEUED) throw runtime_error("IndexedHeap::push: handle already queued");
+        keys.emplace_back();
+        ids.push_back(id);
+        siftUp(keys.size() - 1, std::move(key), id);
+    }
+    
+    // The new priority must not be worse than the current one
+    void decreaseKey(uint32_t id, Priority key) {
+        if (!contains(id)) throw runtime_error("IndexedHeap::decreaseKey: handle not queued");
+        size_t i = position[id];
+        if (comp(keys[i], key)) throw runtime_error("IndexedHeap::decreaseKey: priority would get worse");
+        siftUp(i, std::move(key), id);
+    }
+    
+    // Pushes, or moves an already queued handle up or down
+    void update(uint32_t id, Priority key) {
+        if (!contains(id)) {
+            push(id, std::move(key));
+            return;
+        }
+        size_t i = position[id];
+        if (comp(key, keys[i])) siftUp(i, std::move(key), id);
+        else siftDown(i, std::move(key), id);
+    }
+    
+    uint32_t topId() const {
+        if (empty()) throw runtime_error("IndexedHeap is empty");
+        return ids[0];
+    }
+    
+    const Priority& topPriority() const {
+        if (empty()) throw runtime_error("IndexedHeap is empty");
+        return keys[0];
+    }
+    
+    // Removes the best entry and returns its handle
+    uint32_t pop() {
+        uint32_t id = topId();
+        position[id] = NOT_QUEUED;
+        refillFromBack(0);
+        return id;
+    }
+    
+    bool erase(uint32_t id) {
+        if (!contains(id)) return false;
+        size_t i = position[id];
+        position[id] = NOT_QUEUED;
+        refillFromBack(i);
+        return true;
+    }
+    
+    void clear() {
+        for (uint32_t id : ids) position[id] = NOT_QUEUED;
+        keys.clear();
+        ids.clear();
+    }
+};
+
+// Monotone radix heap
+// For integer keys where nothing smaller than the last popped key is ever
+// pushed, as in Dijkstra and timer queues. Bucket b holds keys whose
+// highest bit differing from the last popped key is bit b-1, so a push is
+// an append. When bucket 0 runs dry, the lowest non-empty bucket is split
+// around its minimum; each entry moves down at most 64 times in total.
+template<typename Value>
+class RadixHeap {
+private:
+    static constexpr size_t BUCKETS = 65;
+    array<vector<pair<uint64_t, Value>>, BUCKETS> buckets;
+    uint64_t last = 0;
+    size_t count = 0;
+    
+    size_t bucketFor(uint64_t key) const {
+        return bit_width(key ^ last);
+    }
+    
+    // Makes bucket 0 (entries equal to last) non-empty
+    void pull() {
+        if (!buckets[0].empty()) return;
+        if (count == 0) throw runtime_error("RadixHeap is empty");
+        size_t b = 1;
+        while (buckets[b].empty()) b++;
+        auto& source = buckets[b];
+        last = min_element(source.begin(), source.end(),
+                           [](const auto& x, const auto& y) { return x.first < y.first; })->first;
+        for (auto& entry : source) {
+            buckets[bucketFor(entry.first)].push_back(std::move(entry));
+        }
+        source.clear();
+    }
+    
+public:
+    size_t size() const { return count; }
+    bool empty() const { return count == 0; }
+    
+    void push(uint64_t key, Value value) {
+        if (key < last) throw runtime_error("RadixHeap::push: key below the last popped key");
+        buckets[bucketFor(key)].emplace_back(key, std::move(value));
+        count++;
+    }
+    
+    uint64_t topKey() {
+        pull();
+        return last;
+    }
+    
+    pair<uint64_t, Value> pop() {
+        pull();
+        pair<uint64_t, Value> entry = std::move(buckets[0].back());
+        buckets[0].pop_back();
+        count--;
+        return entry;
+    }
+    
+    // Keeps bucket capacity for the next run
+    void clear() {
+        for (auto& bucket : buckets) bucket.clear();
+        last = 0;
+        count = 0;
     }
+};
+
+void stlContainers() {
+    cout << "\n=== STL CONTAINERS ===" << endl;
+    
+    // Vector - dynamic array
+    vector<int> vec = {1, 2, 3, 4, 5};
+    vec.push_back(6);
+    cout << "Vector size: " << vec.size() << endl;
+    cout << "Vector elements: ";
+    for (const auto& v : vec) cout << v << " ";
     cout << endl;
     
-    // nullptr (C++11)
-    cout << "\n--- Nullptr ---" << endl;
-    int* ptr = nullptr;  // Better than NULL
-    if (ptr == nullptr) {
-        cout << "Pointer is null" << endl;
+    // List - doubly linked list
+    list<string> lst = {"apple", "banana", "cherry"};
+    lst.push_front("apricot");
+    cout << "List: ";
+    for (const auto& item : lst) cout << item << " ";
+    cout << endl;
+    
+    // Segmented list - same operations, elements stored in chunks
+    SegmentedList<string> segmented = {"apple", "banana", "cherry"};
+    segmented.push_front("apricot");
+    segmented.insert(next(segmented.begin(), 2), "blueberry");
+    cout << "SegmentedList: ";
+    for (const auto& item : segmented) cout << item << " ";
+    cout << "(" << segmented.chunkCount() << " chunks of " << segmented.chunkCapacity() << ")" << endl;
+    
+    // Set - ordered unique elements
+    set<int> s = {3, 1, 4, 1, 5, 9};  // Duplicates removed
+    cout << "Set: ";
+    for (const auto& elem : s) cout << elem << " ";
+    cout << endl;
+    
+    // Map - key-value pairs
+    map<string, int> ages;
+    ages["Alice"] = 30;
+    ages["Bob"] = 25;
+    ages["Charlie"] = 35;
+    
+    cout << "Map (ages):" << endl;
+    for (const auto& pair : ages) {
+        cout << pair.first << ": " << pair.second << endl;
     }
     
-    // Strongly typed enums (C++11)
-    enum class Color { RED, GREEN, BLUE };
-    enum class Size { SMALL, MEDIUM, LARGE };
+    // Hash map with flat storage; string_view lookups need no temporary string
+    FlatHashMap<string, int> flatAges = {{"Alice", 30}, {"Bob", 25}, {"Charlie", 35}};
+    string_view who = "Bob";
+    cout << "FlatHashMap lookup " << who << ": " << flatAges.at(who)
+         << " (" << flatAges.size() << " entries, " << flatAges.bucketCount() << " slots)" << endl;
+    FlatHashSet<int> seen = {3, 1, 4, 1, 5, 9};
+    cout << "FlatHashSet size after dedup: " << seen.size() << endl;
+    
+    // Sorted arrays for build-once, read-many data
+    auto sortedAges = FlatMap<string, int>::fromUnsorted({{"Charlie", 35}, {"Alice", 30}, {"Bob", 25}});
+    cout << "FlatMap in key order:";
+    for (const auto& [name, age] : sortedAges) cout << " " << name << "=" << age;
+    cout << ", Bob is " << sortedAges.at(who) << endl;
+    FlatSet<int> uniqueSorted = {3, 1, 4, 1, 5, 9};
+    cout << "FlatSet:";
+    for (int v : uniqueSorted) cout << " " << v;
+    cout << endl;
     
-    Color c = Color::RED;
-    // Size s = Size::RED;  // Error: different enum types
+    // Queue and Stack (not thread-safe; BlockingQueue in section 13 is)
+    queue<int> q;
+    stack<int> st;
     
-    // constexpr (C++11)
-    constexpr int factorial(int n) {
-        return (n <= 1) ? 1 : n * factorial(n - 1);
+    for (int i = 1; i <= 3; i++) {
+        q.push(i);
+        st.push(i);
     }
     
-    constexpr int fact5 = factorial(5);  // Computed at compile time
-    cout << "5! = " << fact5 << endl;
+    cout << "Queue (FIFO): ";
+    while (!q.empty()) {
+        cout << q.front() << " ";
+        q.pop();
+    }
+    cout << endl;
+    
+    cout << "Stack (LIFO): ";
+    while (!st.empty()) {
+        cout << st.top() << " ";
+        st.pop();
+    }
+    cout << endl;
+    
+    // Indexed heap: task 2 gets more urgent while queued, task 0 is cancelled,
+    // task 1 is pushed back and task 4 is queued through update()
+    IndexedHeap<int> tasks;
+    tasks.push(0, 50);
+    tasks.push(1, 20);
+    tasks.push(2, 40);
+    tasks.push(3, 30);
+    tasks.decreaseKey(2, 10);
+    tasks.erase(0);
+    tasks.update(1, 35);
+    tasks.update(4, 25);
+    cout << "IndexedHeap (task:priority): ";
+    while (!tasks.empty()) {
+        int priority = tasks.topPriority();
+        cout << tasks.pop() << ":" << priority << " ";
+    }
+    cout << endl;
+    try {
+        tasks.decreaseKey(2, 5);  // Already popped
+    } catch (const runtime_error& e) {
+        cout << "Caught: " << e.what() << endl;
+    }
+    cout << "Erase of a popped task: " << boolalpha << tasks.erase(2) << endl;
 }
 
 /*
 ===============================================================================
-                            15. ADVANCED TOPICS
+                            8. STL ALGORITHMS
 ===============================================================================
 */
 
-// 15.1 Function Objects and Functors
-class Multiplier {
+// 8.1 Vectorized Integer Kernels
+// count/transform/accumulate/minmax over int arrays, written once per
+// instruction set and picked at startup by what the CPU supports.
+// Sums are 64-bit so large inputs cannot overflow like an int total can.
+enum class SimdLevel { SCALAR, SSE2, AVX2, AVX512 };
+
+struct IntKernels {
+    const char* name;
+    size_t (*countEqual)(const int* data, size_t n, int value);
+    void (*square)(const int* in, int* out, size_t n);
+    long long (*sum)(const int* data, size_t n);
+    pair<int, int> (*minMax)(const int* data, size_t n);  // {INT_MAX, INT_MIN} if empty
+};
+
+size_t countEqualScalar(const int* data, size_t n, int value) {
+    size_t count = 0;
+    for (size_t i = 0; i < n; i++) count += (data[i] == value);
+    return count;
+}
+
+// Squares with wrap-around like the vector versions instead of signed overflow
+void squareScalar(const int* in, int* out, size_t n) {
+    for (size_t i = 0; i < n; i++) {
+        unsigned int x = static_cast<unsigned int>(in[i]);
+        out[i] = static_cast<int>(x * x);
+    }
+}
+
+long long sumScalar(const int* data, size_t n) {
+    long long total = 0;
+    for (size_t i = 0; i < n; i++) total += data[i];
+    return total;
+}
+
+pair<int, int> minMaxScalar(const int* data, size_t n) {
+    int lo = numeric_limits<int>::max(), hi = numeric_limits<int>::min();
+    for (size_t i = 0; i < n; i++) {
+        lo = min(lo, data[i]);
+        hi = max(hi, data[i]);
+    }
+    return {lo, hi};
+}
+
+#if GUIDE_X86_SIMD
+__attribute__((target("sse2")))
+size_t countEqualSse2(const int* data, size_t n, int value) {
+    const __m128i needle = _mm_set1_epi32(value);
+    size_t count = 0, i = 0;
+    while (i + 4 <= n) {
+        // Lane counters are flushed before they can overflow
+        __m128i counts = _mm_setzero_si128();
+        size_t blockEnd = min(n & ~size_t(3), i + (size_t(1) << 30));
+        for (; i < blockEnd; i += 4) {
+            __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+            counts = _mm_sub_epi32(counts, _mm_cmpeq_epi32(v, needle));
+        }
+        alignas(16) unsigned int lanes[4];
+        _mm_store_si128(reinterpret_cast<__m128i*>(lanes), counts);
+        count += size_t(lanes[0]) + lanes[1] + lanes[2] + lanes[3];
+    }
+    return count + countEqualScalar(data + i, n - i, value);
+}
+
+// SSE2 has no 32-bit mullo; multiply even and odd lanes as 64-bit and repack
+__attribute__((target("sse2")))
+void squareSse2(const int* in, int* out, size_t n) {
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i));
+        __m128i odd = _mm_shuffle_epi32(v, _MM_SHUFFLE(3, 3, 1, 1));
+        __m128i evenProducts = _mm_mul_epu32(v, v);
+        __m128i oddProducts = _mm_mul_epu32(odd, odd);
+        __m128i result = _mm_unpacklo_epi32(
+            _mm_shuffle_epi32(evenProducts, _MM_SHUFFLE(0, 0, 2, 0)),
+            _mm_shuffle_epi32(oddProducts, _MM_SHUFFLE(0, 0, 2, 0)));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), result);
+    }
+    squareScalar(in + i, out + i, n - i);
+}
+
+__attribute__((target("sse2")))
+long long sumSse2(const int* data, size_t n) {
+    __m128i acc = _mm_setzero_si128();
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+        __m128i sign = _mm_srai_epi32(v, 31);
+        acc = _mm_add_epi64(acc, _mm_unpacklo_epi32(v, sign));
+        acc = _mm_add_epi64(acc, _mm_unpackhi_epi32(v, sign));
+    }
+    alignas(16) long long lanes[2];
+    _mm_store_si128(reinterpret_cast<__m128i*>(lanes), acc);
+    return lanes[0] + lanes[1] + sumScalar(data + i, n - i);
+}
+
+__attribute__((target("sse2")))
+pair<int, int> minMaxSse2(const int* data, size_t n) {
+    if (n < 4) return minMaxScalar(data, n);
+    __m128i lo = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data));
+    __m128i hi = lo;
+    size_t i = 4;
+    for (; i + 4 <= n; i += 4) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+        __m128i less = _mm_cmpgt_epi32(lo, v);
+        __m128i greater = _mm_cmpgt_epi32(v, hi);
+        lo = _mm_or_si128(_mm_and_si128(less, v), _mm_andnot_si128(less, lo));
+        hi = _mm_or_si128(_mm_and_si128(greater, v), _mm_andnot_si128(greater, hi));
+    }
+    alignas(16) int loLanes[4], hiLanes[4];
+    _mm_store_si128(reinterpret_cast<__m128i*>(loLanes), lo);
+    _mm_store_si128(reinterpret_cast<__m128i*>(hiLanes), hi);
+    pair<int, int> tail = minMaxScalar(data + i, n - i);
+    return {min({loLanes[0], loLanes[1], loLanes[2], loLanes[3], tail.first}),
+            max({hiLanes[0], hiLanes[1], hiLanes[2], hiLanes[3], tail.second})};
+}
+
+__attribute__((target("avx2")))
+size_t countEqualAvx2(const int* data, size_t n, int value) {
+    const __m256i needle = _mm256_set1_epi32(value);
+    size_t count = 0, i = 0;
+    while (i + 8 <= n) {
+        __m256i counts = _mm256_setzero_si256();
+        size_t blockEnd = min(n & ~size_t(7), i + (size_t(1) << 30));
+        for (; i < blockEnd; i += 8) {
+            __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i));
+            counts = _mm256_sub_epi32(counts, _mm256_cmpeq_epi32(v, needle));
+        }
+        alignas(32) unsigned int lanes[8];
+        _mm256_store_si256(reinterpret_cast<__m256i*>(lanes), counts);
+        for (unsigned int lane : lanes) count += lane;
+    }
+    return count + countEqualScalar(data + i, n - i, value);
+}
+
+__attribute__((target("avx2")))
+void squareAvx2(const int* in, int* out, size_t n) {
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in + i));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), _mm256_mullo_epi32(v, v));
+    }
+    squareScalar(in + i, out + i, n - i);
+}
+
+__attribute__((target("avx2")))
+long long sumAvx2(const int* data, size_t n) {
+    __m256i acc0 = _mm256_setzero_si256();
+    __m256i acc1 = _mm256_setzero_si256();
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i));
+        acc0 = _mm256_add_epi64(acc0, _mm256_cvtepi32_epi64(_mm256_castsi256_si128(v)));
+        acc1 = _mm256_add_epi64(acc1, _mm256_cvtepi32_epi64(_mm256_extracti128_si256(v, 1)));
+    }
+    alignas(32) long long lanes[4];
+    _mm256_store_si256(reinterpret_cast<__m256i*>(lanes), _mm256_add_epi64(acc0, acc1));
+    return lanes[0] + lanes[1] + lanes[2] + lanes[3] + sumScalar(data + i, n - i);
+}
+
+__attribute__((target("avx2")))
+pair<int, int> minMaxAvx2(const int* data, size_t n) {
+    if (n < 8) return minMaxScalar(data, n);
+    __m256i lo = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data));
+    __m256i hi = lo;
+    size_t i = 8;
+    for (; i + 8 <= n; i += 8) {
+        __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i));
+        lo = _mm256_min_epi32(lo, v);
+        hi = _mm256_max_epi32(hi, v);
+    }
+    alignas(32) int loLanes[8], hiLanes[8];
+    _mm256_store_si256(reinterpret_cast<__m256i*>(loLanes), lo);
+    _mm256_store_si256(reinterpret_cast<__m256i*>(hiLanes), hi);
+    pair<int, int> result = minMaxScalar(data + i, n - i);
+    for (int k = 0; k < 8; k++) {
+        result.first = min(result.first, loLanes[k]);
+        result.second = max(result.second, hiLanes[k]);
+    }
+    return result;
+}
+#endif
+
+SimdLevel detectSimdLevel() {
+#if GUIDE_X86_SIMD
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f")) return SimdLevel::AVX512;
+    if (__builtin_cpu_supports("avx2")) return SimdLevel::AVX2;
+    if (__builtin_cpu_supports("sse2")) return SimdLevel::SSE2;
+#endif
+    return SimdLevel::SCALAR;
+}
+
+// Kernels for a specific level; levels without their own use the next one down
+const IntKernels& intKernels(SimdLevel level) {
+    static const IntKernels scalar = {"scalar", countEqualScalar, squareScalar, sumScalar, minMaxScalar};
+#if GUIDE_X86_SIMD
+    static const IntKernels sse2 = {"sse2", countEqualSse2, squareSse2, sumSse2, minMaxSse2};
+    static const IntKernels avx2 = {"avx2", countEqualAvx2, squareAvx2, sumAvx2, minMaxAvx2};
+    if (level >= SimdLevel::AVX2) return avx2;
+    if (level == SimdLevel::SSE2) return sse2;
+#endif
+    return scalar;
+}
+
+// Best kernels for this CPU, detected once
+const IntKernels& intKernels() {
+    static const IntKernels& best = intKernels(detectSimdLevel());
+    return best;
+}
+
+// 8.2 Eytzinger Search Index
+// binary_search on a sorted array jumps all over memory and mispredicts half
+// its branches. Storing the same keys in BFS (Eytzinger) order keeps the
+// first levels of the search in a few cache lines, and the loop below has no
+// data-dependent branch, so the next lines can be prefetched.
+template<typename T>
+class EytzingerIndex {
 private:
-    int factor;
+    vector<T> tree;  // 1-based: children of k are 2k and 2k+1
+    
+    size_t fill(const vector<T>& sorted, size_t i, size_t k) {
+        if (k < tree.size()) {
+            i = fill(sorted, i, 2 * k);
+            tree[k] = sorted[i++];
+            i = fill(sorted, i, 2 * k + 1);
+        }
+        return i;
+    }
     
 public:
-    Multiplier(int f) : factor(f) {}
+    EytzingerIndex() : tree(1) {}  // Slot 0 is unused but always present
     
-    int operator()(int x) const {
-        return x * factor;
+    // `sorted` must be in ascending order
+    explicit EytzingerIndex(const vector<T>& sorted) : tree(sorted.size() + 1) {
+        fill(sorted, 0, 1);
+    }
+    
+    size_t size() const { return tree.size() - 1; }
+    
+    // First element not less than value, or nullptr if there is none
+    const T* lowerBound(const T& value) const {
+        size_t n = tree.size();
+        size_t k = 1;
+        while (k < n) {
+#if defined(__GNUC__) || defined(__clang__)
+            __builtin_prefetch(tree.data() + min(16 * k, n - 1));
+#endif
+            k = 2 * k + (tree[k] < value);
+        }
+        // Undo the trailing right turns plus the final left turn
+        k >>= __builtin_ctzll(~static_cast<unsigned long long>(k)) + 1;
+        return k == 0 ? nullptr : &tree[k];
+    }
+    
+    bool contains(const T& value) const {
+        const T* found = lowerBound(value);
+        return found != nullptr && !(value < *found);
     }
 };
 
-// 15.2 Template Metaprogramming
-template<int N>
-struct Factorial {
-    static const int value = N * Factorial<N-1>::value;
+// 8.3 Batched Geometry Kernels
+// Area and perimeter for whole spans of rectangles or circles in one pass,
+// dispatched like the integer kernels. Each lane does the same operations
+// in the same order as the member functions (no FMA), so the results are
+// bit-for-bit equal to Rectangle::area() and Circle::area().
+struct GeometryKernels {
+    const char* name;
+    void (*rectangles)(const double* widths, const double* heights,
+                       double* areas, double* perimeters, size_t n);
+    void (*circles)(const double* radii, double* areas, double* perimeters, size_t n);
 };
 
-template<>
-struct Factorial<0> {
-    static const int value = 1;
-};
+void rectanglesScalar(const double* w, const double* h, double* area, double* perimeter, size_t n) {
+    for (size_t i = 0; i < n; i++) {
+        area[i] = w[i] * h[i];
+        perimeter[i] = 2 * (w[i] + h[i]);
+    }
+}
+
+void circlesScalar(const double* r, double* area, double* perimeter, size_t n) {
+    for (size_t i = 0; i < n; i++) {
+        area[i] = numbers::pi * r[i] * r[i];
+        perimeter[i] = 2 * numbers::pi * r[i];
+    }
+}
+
+#if GUIDE_X86_SIMD
+__attribute__((target("avx2")))
+void rectanglesAvx2(const double* w, const double* h, double* area, double* perimeter, size_t n) {
+    const __m256d two = _mm256_set1_pd(2.0);
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m256d vw = _mm256_loadu_pd(w + i);
+        __m256d vh = _mm256_loadu_pd(h + i);
+        _mm256_storeu_pd(area + i, _mm256_mul_pd(vw, vh));
+        _mm256_storeu_pd(perimeter + i, _mm256_mul_pd(two, _mm256_add_pd(vw, vh)));
+    }
+    rectanglesScalar(w + i, h + i, area + i, perimeter + i, n - i);
+}
+
+__attribute__((target("avx2")))
+void circlesAvx2(const double* r, double* area, double* perimeter, size_t n) {
+    const __m256d pi = _mm256_set1_pd(numbers::pi);
+    const __m256d twoPi = _mm256_set1_pd(2 * numbers::pi);
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m256d vr = _mm256_loadu_pd(r + i);
+        _mm256_storeu_pd(area + i, _mm256_mul_pd(_mm256_mul_pd(pi, vr), vr));
+        _mm256_storeu_pd(perimeter + i, _mm256_mul_pd(twoPi, vr));
+    }
+    circlesScalar(r + i, area + i, perimeter + i, n - i);
+}
+
+// Masked loads and stores handle the last partial vector
+__attribute__((target("avx512f")))
+void rectanglesAvx512(const double* w, const double* h, double* area, double* perimeter, size_t n) {
+    const __m512d two = _mm512_set1_pd(2.0);
+    for (size_t i = 0; i < n; i += 8) {
+        __mmask8 mask = n - i >= 8 ? 0xFF : static_cast<__mmask8>((1u << (n - i)) - 1);
+        __m512d vw = _mm512_maskz_loadu_pd(mask, w + i);
+        __m512d vh = _mm512_maskz_loadu_pd(mask, h + i);
+        _mm512_mask_storeu_pd(area + i, mask, _mm512_mul_pd(vw, vh));
+        _mm512_mask_storeu_pd(perimeter + i, mask, _mm512_mul_pd(two, _mm512_add_pd(vw, vh)));
+    }
+}
+
+__attribute__((target("avx512f")))
+void circlesAvx512(const double* r, double* area, double* perimeter, size_t n) {
+    const __m512d pi = _mm512_set1_pd(numbers::pi);
+    const __m512d twoPi = _mm512_set1_pd(2 * numbers::pi);
+    for (size_t i = 0; i < n; i += 8) {
+        __mmask8 mask = n - i >= 8 ? 0xFF : static_cast<__mmask8>((1u << (n - i)) - 1);
+        __m512d vr = _mm512_maskz_loadu_pd(mask, r + i);
+        _mm512_mask_storeu_pd(area + i, mask, _mm512_mul_pd(_mm512_mul_pd(pi, vr), vr));
+        _mm512_mask_storeu_pd(perimeter + i, mask, _mm512_mul_pd(twoPi, vr));
+    }
+}
+#endif
+
+const GeometryKernels& geometryKernels(SimdLevel level) {
+    static const GeometryKernels scalar = {"scalar", rectanglesScalar, circlesScalar};
+#if GUIDE_X86_SIMD
+    static const GeometryKernels avx2 = {"avx2", rectanglesAvx2, circlesAvx2};
+    static const GeometryKernels avx512 = {"avx512", rectanglesAvx512, circlesAvx512};
+    if (level == SimdLevel::AVX512) return avx512;
+    if (level == SimdLevel::AVX2) return avx2;
+#endif
+    return scalar;
+}
+
+const GeometryKernels& geometryKernels() {
+    static const GeometryKernels& best = geometryKernels(detectSimdLevel());
+    return best;
+}
+
+// Outputs must be at least as long as the inputs
+void rectangleMetrics(span<const double> widths, span<const double> heights,
+                      span<double> areas, span<double> perimeters) {
+    if (heights.size() != widths.size() || areas.size() < widths.size() || perimeters.size() < widths.size()) {
+        throw runtime_error("rectangleMetrics: span sizes do not match");
+    }
+    geometryKernels().rectangles(widths.data(), heights.data(), areas.data(), perimeters.data(), widths.size());
+}
+
+void circleMetrics(span<const double> radii, span<double> areas, span<double> perimeters) {
+    if (areas.size() < radii.size() || perimeters.size() < radii.size()) {
+        throw runtime_error("circleMetrics: span sizes do not match");
+    }
+    geometryKernels().circles(radii.data(), areas.data(), perimeters.data(), radii.size());
+}
+
+void stlAlgorithms() {
+    cout << "\n=== STL ALGORITHMS ===" << endl;
+    
+    vector<int> numbers = {64, 34, 25, 12, 22, 11, 90};
+    
+    // Sort
+    sort(numbers.begin(), numbers.end());
+    cout << "Sorted: ";
+    for (const auto& n : numbers) cout << n << " ";
+    cout << endl;
+    
+    // Find
+    auto it = find(numbers.begin(), numbers.end(), 25);
+    if (it != numbers.end()) {
+        cout << "Found 25 at position: " << distance(numbers.begin(), it) << endl;
+    }
+    
+    // Binary search (requires sorted container)
+    bool found = binary_search(numbers.begin(), numbers.end(), 22);
+    cout << "22 exists: " << boolalpha << found << endl;
+    
+    // Same lookup through a cache-friendly index built from the sorted data
+    EytzingerIndex<int> index(numbers);
+    cout << "22 in index: " << index.contains(22) << ", 23 in index: " << index.contains(23) << endl;
+    
+    // Count
+    vector<int> data = {1, 2, 2, 3, 2, 4, 2};
+    auto twos = count(data.begin(), data.end(), 2);
+    cout << "Count of 2s: " << twos << endl;
+    
+    // Transform
+    vector<int> squared(data.size());
+    transform(data.begin(), data.end(), squared.begin(), 
+              [](int x) { return x * x; });
+    cout << "Squared: ";
+    for (const auto& n : squared) cout << n << " ";
+    cout << endl;
+    
+    // Accumulate (sum) - a long long initial value keeps the total from overflowing
+    long long sum = accumulate(numbers.begin(), numbers.end(), 0LL);
+    cout << "Sum: " << sum << endl;
+    
+    // Same operations with the vectorized kernels
+    const IntKernels& kernels = intKernels();
+    vector<int> simdSquared(data.size());
+    kernels.square(data.data(), simdSquared.data(), data.size());
+    pair<int, int> range = kernels.minMax(numbers.data(), numbers.size());
+    cout << "SIMD (" << kernels.name << "): count=" << kernels.countEqual(data.data(), data.size(), 2)
+         << ", sum=" << kernels.sum(numbers.data(), numbers.size())
+         << ", min=" << range.first << ", max=" << range.second
+         << ", squares match: " << boolalpha << (simdSquared == squared) << endl;
+    
+    // Whole batches of shapes at once
+    vector<double> widths = {1, 2, 3}, heights = {4, 5, 6}, radii = {1, 2};
+    vector<double> rectAreas(3), rectPerimeters(3), circleAreas(2), circlePerimeters(2);
+    rectangleMetrics(widths, heights, rectAreas, rectPerimeters);
+    circleMetrics(radii, circleAreas, circlePerimeters);
+    cout << "Batched geometry (" << geometryKernels().name << "): rectangle areas "
+         << rectAreas[0] << " " << rectAreas[1] << " " << rectAreas[2]
+         << ", circle perimeters " << circlePerimeters[0] << " " << circlePerimeters[1] << endl;
+}
+
+/*
+===============================================================================
+                            9. TEMPLATES
+===============================================================================
+*/
+
+// 9.1 Function Templates
+template<typename T>
+T maximum(T a, T b) {
+    return (a > b) ? a : b;
+}
+
+// Function template specialization
+template<>
+const char* maximum<const char*>(const char* a, const char* b) {
+    return (strcmp(a, b) > 0) ? a : b;
+}
+
+// 9.2 Class Templates
+// The allocator parameter lets a stack draw from an arena or pool, e.g.
+// Stack<int, pmr::polymorphic_allocator<int>> s(&monotonicResource);
+template<typename T, typename Allocator = allocator<T>>
+class Stack {
+private:
+    vector<T, Allocator> elements;
+    
+public:
+    Stack() = default;
+    explicit Stack(const Allocator& alloc) : elements(alloc) {}
+    
+    void push(const T& element) {
+        elements.push_back(element);
+    }
+    
+    void push(T&& element) {
+        elements.push_back(move(element));
+    }
+    
+    // Constructs the new top in place
+    template<typename... Args>
+    T& emplace(Args&&... args) {
+        return elements.emplace_back(forward<Args>(args)...);
+    }
+    
+    // Removes the top element and hands it back by move
+    T pop() {
+        if (elements.empty()) {
+            throw runtime_error("Stack is empty");
+        }
+        T value = move(elements.back());
+        elements.pop_back();
+        return value;
+    }
+    
+    T& top() {
+        if (elements.empty()) {
+            throw runtime_error("Stack is empty");
+        }
+        return elements.back();
+    }
+    
+    const T& top() const {
+        if (elements.empty()) {
+            throw runtime_error("Stack is empty");
+        }
+        return elements.back();
+    }
+    
+    bool empty() const {
+        return elements.empty();
+    }
+    
+    size_t size() const {
+        return elements.size();
+    }
+    
+    void reserve(size_t capacity) {
+        elements.reserve(capacity);
+    }
+};
+
+template<typename T>
+using PmrStack = Stack<T, pmr::polymorphic_allocator<T>>;
+
+// 9.3 Fixed-Capacity Inline Stack
+// Keeps the first N elements inside the object itself, so small stacks never
+// touch the heap; pushing past N moves everything to a heap buffer.
+template<typename T, size_t N>
+class SmallStack {
+    static_assert(N > 0, "SmallStack needs room for at least one element");
+    
+private:
+    alignas(T) unsigned char inlineBuffer[N * sizeof(T)];
+    T* items;
+    size_t count = 0;
+    size_t reserved = N;
+    
+    T* inlineItems() { return reinterpret_cast<T*>(inlineBuffer); }
+    
+    static T* allocate(size_t n) {
+        return static_cast<T*>(::operator new(n * sizeof(T), align_val_t(alignof(T))));
+    }
+    
+    void releaseHeap() {
+        if (!isInline()) {
+            ::operator delete(items, align_val_t(alignof(T)));
+            items = inlineItems();
+            reserved = N;
+        }
+    }
+    
+    void grow() {
+        size_t newReserved = reserved * 2;
+        T* bigger = allocate(newReserved);
+        size_t moved = 0;
+        try {
+            for (; moved < count; moved++) {
+                new (bigger + moved) T(move_if_noexcept(items[moved]));
+            }
+        } catch (...) {
+            for (size_t i = 0; i < moved; i++) bigger[i].~T();
+            ::operator delete(bigger, align_val_t(alignof(T)));
+            throw;
+        }
+        size_t kept = count;
+        clear();
+        releaseHeap();
+        items = bigger;
+        count = kept;
+        reserved = newReserved;
+    }
+    
+    // Expects *this to be empty and inline
+    void takeFrom(SmallStack&& other) {
+        if (other.isInline()) {
+            for (size_t i = 0; i < other.count; i++) {
+                new (items + i) T(move(other.items[i]));
+            }
+            count = other.count;
+            other.clear();
+        } else {
+            items = other.items;
+            count = other.count;
+            reserved = other.reserved;
+            other.items = other.inlineItems();
+            other.count = 0;
+            other.reserved = N;
+        }
+    }
+    
+public:
+    SmallStack() : items(inlineItems()) {}
+    
+    SmallStack(const SmallStack& other) : items(inlineItems()) {
+        for (size_t i = 0; i < other.count; i++) {
+            push(other.items[i]);
+        }
+    }
+    
+    SmallStack(SmallStack&& other) noexcept(is_nothrow_move_constructible<T>::value)
+        : items(inlineItems()) {
+        takeFrom(move(other));
+    }
+    
+    SmallStack& operator=(const SmallStack& other) {
+        if (this != &other) {
+            SmallStack copy(other);
+            clear();
+            releaseHeap();
+            takeFrom(move(copy));
+        }
+        return *this;
+    }
+    
+    SmallStack& operator=(SmallStack&& other) noexcept(is_nothrow_move_constructible<T>::value) {
+        if (this != &other) {
+            clear();
+            releaseHeap();
+            takeFrom(move(other));
+        }
+        return *this;
+    }
+    
+    ~SmallStack() {
+        clear();
+        releaseHeap();
+    }
+    
+    template<typename... Args>
+    T& emplace(Args&&... args) {
+        if (count == reserved) {
+            // Build first: args may refer to an element that grow() moves
+            T value(forward<Args>(args)...);
+            grow();
+            return *new (items + count++) T(move(value));
+        }
+        return *new (items + count++) T(forward<Args>(args)...);
+    }
+    
+    void push(const T& element) { emplace(element); }
+    void push(T&& element) { emplace(move(element)); }
+    
+    T pop() {
+        if (count == 0) {
+            throw runtime_error("Stack is empty");
+        }
+        T value = move(items[count - 1]);
+        items[--count].~T();
+        return value;
+    }
+    
+    T& top() {
+        if (count == 0) {
+            throw runtime_error("Stack is empty");
+        }
+        return items[count - 1];
+    }
+    
+    const T& top() const {
+        if (count == 0) {
+            throw runtime_error("Stack is empty");
+        }
+        return items[count - 1];
+    }
+    
+    void clear() {
+        while (count > 0) {
+            items[--count].~T();
+        }
+    }
+    
+    bool empty() const { return count == 0; }
+    size_t size() const { return count; }
+    size_t capacity() const { return reserved; }
+    bool isInline() const { return items == reinterpret_cast<const T*>(inlineBuffer); }
+};
+
+void templateExamples() {
+    cout << "\n=== TEMPLATES ===" << endl;
+    
+    // Function templates
+    cout << "Max of 10, 20: " << maximum(10, 20) << endl;
+    cout << "Max of 3.14, 2.71: " << maximum(3.14, 2.71) << endl;
+    cout << "Max of strings: " << maximum(string("apple"), string("banana")) << endl;
+    
+    // Class templates
+    Stack<int> intStack;
+    intStack.push(1);
+    intStack.push(2);
+    intStack.push(3);
+    
+    cout << "Stack size: " << intStack.size() << endl;
+    cout << "Top element: " << intStack.top() << endl;
+    
+    Stack<string> stringStack;
+    stringStack.push("Hello");
+    stringStack.emplace(5, '!');
+    stringStack.top() += "?";  // top() returns a reference
+    cout << "String stack top: " << stringStack.top() << endl;
+    string popped = stringStack.pop();  // Moved out, not copied
+    cout << "Popped: " << popped << ", new top: " << stringStack.top() << endl;
+    
+    // Stack backed by a stack-allocated arena instead of the heap
+    array<byte, 1024> arena;
+    pmr::monotonic_buffer_resource arenaResource(arena.data(), arena.size());
+    PmrStack<int> arenaStack(&arenaResource);
+    for (int i = 1; i <= 5; i++) arenaStack.push(i * 10);
+    cout << "Arena stack top: " << arenaStack.top() << ", size: " << arenaStack.size() << endl;
+    
+    // Inline storage until the 5th element
+    SmallStack<string, 4> smallStack;
+    for (int i = 0; i < 4; i++) smallStack.emplace("item" + to_string(i));
+    cout << "SmallStack inline with " << smallStack.size() << ": " << boolalpha << smallStack.isInline() << endl;
+    smallStack.push("item4");
+    cout << "SmallStack inline with " << smallStack.size() << ": " << smallStack.isInline() << endl;
+}
+
+/*
+===============================================================================
+                            10. EXCEPTION HANDLING
+===============================================================================
+*/
+
+class CustomException : public exception {
+private:
+    string message;
+    
+public:
+    CustomException(const string& msg) : message(msg) {}
+    
+    const char* what() const noexcept override {
+        return message.c_str();
+    }
+};
+
+void riskyFunction(int value) {
+    if (value < 0) {
+        throw invalid_argument("Value cannot be negative");
+    }
+    if (value == 0) {
+        throw CustomException("Custom error: Value is zero");
+    }
+    cout << "Value is: " << value << endl;
+}
+
+void exceptionHandling() {
+    cout << "\n=== EXCEPTION HANDLING ===" << endl;
+    
+    vector<int> testValues = {5, -1, 0, 10};
+    
+    for (int val : testValues) {
+        try {
+            riskyFunction(val);
+        }
+        catch (const invalid_argument& e) {
+            cout << "Invalid argument: " << e.what() << endl;
+        }
+        catch (const CustomException& e) {
+            cout << "Custom exception: " << e.what() << endl;
+        }
+        catch (const exception& e) {
+            cout << "Generic exception: " << e.what() << endl;
+        }
+        catch (...) {
+            cout << "Unknown exception caught" << endl;
+        }
+    }
+    
+    // RAII example with smart pointers (automatic cleanup)
+    try {
+        unique_ptr<int[]> arr(new int[1000]);
+        // Even if exception occurs, memory is automatically freed
+        throw runtime_error("Something went wrong");
+    }
+    catch (const exception& e) {
+        cout << "Caught: " << e.what() << " (memory still cleaned up)" << endl;
+    }
+}
+
+/*
+===============================================================================
+                            11. SMART POINTERS (C++11)
+===============================================================================
+*/
+
+class Resource {
+public:
+    Resource(const string& name) : name_(name) {
+        cout << "Resource " << name_ << " created" << endl;
+    }
+    
+    ~Resource() {
+        cout << "Resource " << name_ << " destroyed" << endl;
+    }
+    
+    void use() {
+        cout << "Using resource " << name_ << endl;
+    }
+    
+private:
+    string name_;
+    [[no_unique_address]] LifecycleTracker<Resource> tracker;
+};
+
+void smartPointers() {
+    cout << "\n=== SMART POINTERS ===" << endl;
+    
+    // unique_ptr - exclusive ownership
+    {
+        unique_ptr<Resource> res1 = make_unique<Resource>("A");
+        res1->use();
+        
+        // Transfer ownership
+        unique_ptr<Resource> res2 = move(res1);
+        if (!res1) {
+            cout << "res1 is now empty" << endl;
+        }
+        res2->use();
+    } // res2 automatically destroyed here
+    
+    // shared_ptr - shared ownership
+    {
+        shared_ptr<Resource> res1 = make_shared<Resource>("B");
+        cout << "Reference count: " << res1.use_count() << endl;
+        
+        {
+            shared_ptr<Resource> res2 = res1;  // Shared ownership
+            cout << "Reference count: " << res1.use_count() << endl;
+            res2->use();
+        } // res2 goes out of scope, but resource not destroyed
+        
+        cout << "Reference count after res2 destroyed: " << res1.use_count() << endl;
+        res1->use();
+    } // Now resource is destroyed
+    
+    // weak_ptr - non-owning observer
+    weak_ptr<Resource> weak;
+    {
+        shared_ptr<Resource> shared = make_shared<Resource>("C");
+        weak = shared;
+        
+        if (auto locked = weak.lock()) {
+            locked->use();
+        }
+    } // shared goes out of scope, resource destroyed
+    
+    if (weak.expired()) {
+        cout << "Weak pointer expired" << endl;
+    }
+}
+
+/*
+===============================================================================
+                            12. FILE I/O
+===============================================================================
+*/
+
+// Memory-mapped files
+// ifstream copies every byte from the kernel into our buffer. Mapping the
+// file lets us read the page cache in place: binary records become a span,
+// text lines become string_views pointing straight into the mapping.
+
+// Iterates over the lines of a buffer without copying (like getline, the
+// '\n' is dropped and a final newline does not produce an empty line)
+class LineView {
+private:
+    string_view text;
+    
+public:
+    class iterator {
+    private:
+        string_view rest;
+        string_view line;
+        bool done;
+        
+        void advance() {
+            if (rest.empty()) {
+                done = true;
+                return;
+            }
+            const void* newline = memchr(rest.data(), '\n', rest.size());
+            size_t length = newline ? static_cast<const char*>(newline) - rest.data() : rest.size();
+            line = rest.substr(0, length);
+            rest.remove_prefix(min(rest.size(), length + 1));
+        }
+        
+    public:
+        using iterator_category = input_iterator_tag;
+        using value_type = string_view;
+        using difference_type = ptrdiff_t;
+        using pointer = const string_view*;
+        using reference = const string_view&;
+        
+        iterator() : done(true) {}
+        explicit iterator(string_view text) : rest(text), done(false) { advance(); }
+        
+        reference operator*() const { return line; }
+        pointer operator->() const { return &line; }
+        iterator& operator++() { advance(); return *this; }
+        iterator operator++(int) { iterator copy = *this; advance(); return copy; }
+        
+        bool operator==(const iterator& other) const {
+            return done == other.done && (done || line.data() == other.line.data());
+        }
+        bool operator!=(const iterator& other) const { return !(*this == other); }
+    };
+    
+    explicit LineView(string_view t) : text(t) {}
+    iterator begin() const { return iterator(text); }
+    iterator end() const { return iterator(); }
+};
+
+class MappedFile {
+public:
+    enum class Access { NORMAL, SEQUENTIAL, RANDOM };
+    
+private:
+    const char* bytes = nullptr;
+    size_t length = 0;
+#if !GUIDE_POSIX
+    vector<char> fallback;  // No mmap: read the whole file instead
+#endif
+    
+    void release() {
+#if GUIDE_POSIX
+        if (bytes != nullptr) {
+            munmap(const_cast<char*>(bytes), length);
+        }
+#endif
+        bytes = nullptr;
+        length = 0;
+    }
+    
+public:
+    explicit MappedFile(const string& path, Access access = Access::SEQUENTIAL) {
+#if GUIDE_POSIX
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) {
+            throw runtime_error("Cannot open " + path);
+        }
+        struct stat info;
+        if (fstat(fd, &info) != 0) {
+            ::close(fd);
+            throw runtime_error("Cannot stat " + path);
+        }
+        length = static_cast<size_t>(info.st_size);
+        if (length > 0) {
+            void* mapped = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (mapped == MAP_FAILED) {
+                ::close(fd);
+                throw runtime_error("Cannot map " + path);
+            }
+            bytes = static_cast<const char*>(mapped);
+        }
+        ::close(fd);  // The mapping keeps the file alive
+        advise(access);
+#else
+        ifstream in(path, ios::binary);
+        if (!in) {
+            throw runtime_error("Cannot open " + path);
+        }
+        fallback.assign(istreambuf_iterator<char>(in), istreambuf_iterator<char>());
+        bytes = fallback.data();
+        length = fallback.size();
+        (void)access;
+#endif
+    }
+    
+    ~MappedFile() { release(); }
+    
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    
+    MappedFile(MappedFile&& other) noexcept { *this = move(other); }
+    
+    MappedFile& operator=(MappedFile&& other) noexcept {
+        if (this != &other) {
+            release();
+#if !GUIDE_POSIX
+            fallback = move(other.fallback);
+#endif
+            bytes = other.bytes;
+            length = other.length;
+            other.bytes = nullptr;
+            other.length = 0;
+        }
+        return *this;
+    }
+    
+    // Tells the kernel how the mapping will be read (read-ahead policy)
+    void advise(Access access) {
+#if GUIDE_POSIX
+        if (bytes == nullptr) return;
+        int advice = access == Access::SEQUENTIAL ? MADV_SEQUENTIAL
+                   : access == Access::RANDOM ? MADV_RANDOM : MADV_NORMAL;
+        madvise(const_cast<char*>(bytes), length, advice);
+#else
+        (void)access;
+#endif
+    }
+    
+    // Starts reading the whole file in ahead of use
+    void prefetch() {
+#if GUIDE_POSIX
+        if (bytes != nullptr) madvise(const_cast<char*>(bytes), length, MADV_WILLNEED);
+#endif
+    }
+    
+    const char* data() const { return bytes; }
+    size_t size() const { return length; }
+    bool empty() const { return length == 0; }
+    string_view view() const { return string_view(bytes, length); }
+    LineView lines() const { return LineView(view()); }
+    
+    // The file as an array of fixed-size records
+    template<typename T>
+    span<const T> as() const {
+        static_assert(is_trivially_copyable<T>::value, "Records must be trivially copyable");
+        if (length % sizeof(T) != 0) {
+            throw runtime_error("File size is not a multiple of the record size");
+        }
+        if (reinterpret_cast<uintptr_t>(bytes) % alignof(T) != 0) {
+            throw runtime_error("File data is not aligned for the record type");
+        }
+        return span<const T>(reinterpret_cast<const T*>(bytes), length / sizeof(T));
+    }
+};
+
+// Buffered writer
+// ofstream << endl flushes after every line. This collects output in a large
+// buffer and only writes when the buffer fills up or flush()/close() is called.
+class BufferedWriter {
+private:
+    FILE* file = nullptr;
+    vector<char> buffer;
+    size_t used = 0;
+    
+    void requireOpen() const {
+        if (file == nullptr) {
+            throw runtime_error("Write after close");
+        }
+    }
+    
+public:
+    explicit BufferedWriter(const string& path, size_t bufferSize = 1 << 20)
+        : buffer(max<size_t>(bufferSize, 64)) {
+        file = fopen(path.c_str(), "wb");
+        if (file == nullptr) {
+            throw runtime_error("Cannot open " + path + " for writing");
+        }
+        setvbuf(file, nullptr, _IONBF, 0);  // We already buffer
+    }
+    
+    ~BufferedWriter() {
+        try {
+            close();
+        } catch (...) {
+            // Destructors must not throw; call close() to see write errors
+        }
+    }
+    
+    BufferedWriter(const BufferedWriter&) = delete;
+    BufferedWriter& operator=(const BufferedWriter&) = delete;
+    
+    void write(string_view text) {
+        requireOpen();
+        if (text.size() > buffer.size() - used) {
+            flush();
+            if (text.size() >= buffer.size()) {
+                if (fwrite(text.data(), 1, text.size(), file) != text.size()) {
+                    throw runtime_error("Write failed");
+                }
+                return;
+            }
+        }
+        memcpy(buffer.data() + used, text.data(), text.size());
+        used += text.size();
+    }
+    
+    void put(char c) {
+        requireOpen();
+        if (used == buffer.size()) flush();
+        buffer[used++] = c;
+    }
+    
+    void writeLine(string_view text) {
+        write(text);
+        put('\n');
+    }
+    
+    BufferedWriter& operator<<(string_view text) { write(text); return *this; }
+    BufferedWriter& operator<<(char c) { put(c); return *this; }
+    
+    BufferedWriter& operator<<(long long value) {
+        char digits[24];
+        auto result = to_chars(digits, digits + sizeof(digits), value);
+        write(string_view(digits, result.ptr - digits));
+        return *this;
+    }
+    
+    BufferedWriter& operator<<(int value) { return *this << static_cast<long long>(value); }
+    
+    void flush() {
+        requireOpen();
+        if (used > 0) {
+            if (fwrite(buffer.data(), 1, used, file) != used) {
+                throw runtime_error("Write failed");
+            }
+            used = 0;
+        }
+    }
+    
+    void close() {
+        if (file != nullptr) {
+            flush();
+            fclose(file);
+            file = nullptr;
+        }
+    }
+};
+
+void fileIO() {
+    cout << "\n=== FILE I/O ===" << endl;
+    
+    // Write to file
+    ofstream outFile("example.txt");
+    if (outFile.is_open()) {
+        // '\n' instead of endl: endl also flushes the stream on every line
+        outFile << "Hello, File I/O!" << '\n';
+        outFile << "Line 2" << '\n';
+        outFile << "Numbers: ";
+        for (int i = 1; i <= 5; i++) {
+            outFile << i << " ";
+        }
+        outFile << '\n';
+        outFile.close();
+        cout << "Data written to file" << endl;
+    }
+    
+    // Read from file
+    ifstream inFile("example.txt");
+    if (inFile.is_open()) {
+        string line;
+        cout << "Reading from file:" << endl;
+        while (getline(inFile, line)) {
+            cout << line << endl;
+        }
+        inFile.close();
+    }
+    
+    // Binary file operations
+    ofstream binFile("data.bin", ios::binary);
+    if (binFile.is_open()) {
+        int numbers[] = {1, 2, 3, 4, 5};
+        binFile.write(reinterpret_cast<const char*>(numbers), sizeof(numbers));
+        binFile.close();
+    }
+    
+    ifstream binRead("data.bin", ios::binary);
+    if (binRead.is_open()) {
+        int readNumbers[5];
+        binRead.read(reinterpret_cast<char*>(readNumbers), sizeof(readNumbers));
+        cout << "Binary data read: ";
+        for (int i = 0; i < 5; i++) {
+            cout << readNumbers[i] << " ";
+        }
+        cout << endl;
+        binRead.close();
+    }
+    
+    // Memory-mapped reads: no copies, the data stays in the page cache
+    {
+        MappedFile textMap("example.txt");
+        cout << "Mapped lines:";
+        for (string_view line : textMap.lines()) {
+            cout << " [" << line << "]";
+        }
+        cout << endl;
+        
+        MappedFile binMap("data.bin", MappedFile::Access::RANDOM);
+        span<const int> records = binMap.as<int>();
+        cout << "Mapped binary records (" << records.size() << "): ";
+        for (int value : records) {
+            cout << value << " ";
+        }
+        cout << endl;
+    }
+    
+    // Buffered writer: one write for the whole file
+    {
+        BufferedWriter writer("example_buffered.txt");
+        for (int i = 1; i <= 3; i++) {
+            writer << "Line " << i << '\n';
+        }
+    }
+    cout << "Buffered file size: " << MappedFile("example_buffered.txt").size() << " bytes" << endl;
+    
+    // String streams
+    stringstream ss;
+    ss << "Age: " << 25 << ", Score: " << 98.5;
+    cout << "String stream: " << ss.str() << endl;
+    
+    // Parse without a stream: split on whitespace and convert in place
+    Tokenizer parser("42 3.14 Hello");
+    int intVal = 0;
+    double doubleVal = 0;
+    string_view stringVal;
+    if (parser.next(intVal) && parser.next(doubleVal) && parser.next(stringVal)) {
+        cout << "Parsed: " << intVal << ", " << doubleVal << ", " << stringVal << endl;
+    }
+}
+
+/*
+===============================================================================
+                            13. MULTITHREADING (C++11)
+===============================================================================
+*/
+
+void workerFunction(int id) {
+    for (int i = 0; i < 3; i++) {
+        cout << "Worker " << id << " working... step " << i + 1 << endl;
+        this_thread::sleep_for(chrono::milliseconds(500));
+    }
+    cout << "Worker " << id << " finished" << endl;
+}
+
+mutex mtx;
+int sharedCounter = 0;
+
+void incrementCounter(int id) {
+    for (int i = 0; i < 1000; i++) {
+        lock_guard<mutex> lock(mtx);  // Automatic lock/unlock
+        sharedCounter++;
+    }
+    cout << "Thread " << id << " finished incrementing" << endl;
+}
+
+// Lock-free counters
+// A single atomic avoids the mutex but every thread still fights over one
+// cache line. ShardedCounter gives each thread its own padded slot and only
+// pays for the sum when the value is read.
+constexpr size_t CACHE_LINE_SIZE = 64;
+
+atomic<long long> atomicCounter{0};
+
+void incrementAtomicCounter(int id) {
+    for (int i = 0; i < 1000; i++) {
+        atomicCounter.fetch_add(1, memory_order_relaxed);
+    }
+    cout << "Thread " << id << " finished atomic incrementing" << endl;
+}
+
+class ShardedCounter {
+private:
+    struct alignas(CACHE_LINE_SIZE) Slot {
+        atomic<long long> value{0};
+    };
+    
+    vector<Slot> slots;
+    
+    // Threads get a stable index the first time they touch any counter
+    static size_t threadIndex() {
+        static atomic<size_t> nextIndex{0};
+        thread_local size_t index = nextIndex.fetch_add(1, memory_order_relaxed);
+        return index;
+    }
+    
+public:
+    explicit ShardedCounter(size_t shards = thread::hardware_concurrency())
+        : slots(shards == 0 ? 1 : shards) {}
+    
+    ShardedCounter(const ShardedCounter&) = delete;
+    ShardedCounter& operator=(const ShardedCounter&) = delete;
+    
+    void increment(long long n = 1) {
+        slots[threadIndex() % slots.size()].value.fetch_add(n, memory_order_relaxed);
+    }
+    
+    // Aggregate read; concurrent increments may or may not be included
+    long long load() const {
+        long long total = 0;
+        for (const auto& slot : slots) {
+            total += slot.value.load(memory_order_relaxed);
+        }
+        return total;
+    }
+    
+    void reset() {
+        for (auto& slot : slots) {
+            slot.value.store(0, memory_order_relaxed);
+        }
+    }
+    
+    size_t shardCount() const { return slots.size(); }
+};
+
+ShardedCounter shardedCounter;
+
+void incrementShardedCounter(int id) {
+    for (int i = 0; i < 1000; i++) {
+        shardedCounter.increment();
+    }
+    cout << "Thread " << id << " finished sharded incrementing" << endl;
+}
+
+int calculateSquare(int x) {
+    this_thread::sleep_for(chrono::milliseconds(1000));
+    return x * x;
+}
+
+// Work-stealing thread pool
+// Starting an OS thread per task costs more than most tasks do. The pool
+// keeps a fixed set of workers, each with its own deque: the owner pushes
+// and pops at the back (LIFO, cache-warm), idle workers steal from the front.
+class ThreadPool {
+private:
+    struct WorkQueue {
+        mutex lock;
+        deque<function<void()>> tasks;
+    };
+    
+    vector<unique_ptr<WorkQueue>> queues;
+    vector<thread> workers;
+    atomic<size_t> pending{0};      // Tasks queued but not yet started
+    atomic<size_t> sleepers{0};
+    atomic<size_t> nextQueue{0};    // Round-robin target for outside submits
+    atomic<bool> stopping{false};
+    mutex sleepMutex;
+    condition_variable wakeUp;
+    
+    // Which pool/queue the current thread works for (none for outside threads)
+    static thread_local ThreadPool* currentPool;
+    static thread_local size_t currentIndex;
+    
+    void enqueue(function<void()> task) {
+        size_t index = (currentPool == this)
+            ? currentIndex
+            : nextQueue.fetch_add(1, memory_order_relaxed) % queues.size();
+        {
+            lock_guard<mutex> lock(queues[index]->lock);
+            queues[index]->tasks.push_back(move(task));
+        }
+        pending.fetch_add(1);
+        if (sleepers.load() > 0) {
+            lock_guard<mutex> lock(sleepMutex);
+            wakeUp.notify_one();
+        }
+    }
+    
+    bool popLocal(size_t index, function<void()>& task) {
+        WorkQueue& queue = *queues[index];
+        lock_guard<mutex> lock(queue.lock);
+        if (queue.tasks.empty()) return false;
+        task = move(queue.tasks.back());
+        queue.tasks.pop_back();
+        return true;
+    }
+    
+    bool steal(size_t thief, function<void()>& task) {
+        for (size_t i = 1; i <= queues.size(); i++) {
+            WorkQueue& victim = *queues[(thief + i) % queues.size()];
+            unique_lock<mutex> lock(victim.lock, try_to_lock);
+            if (lock.owns_lock() && !victim.tasks.empty()) {
+                task = move(victim.tasks.front());
+                victim.tasks.pop_front();
+                return true;
+            }
+        }
+        return false;
+    }
+    
+    bool findTask(size_t index, function<void()>& task) {
+        if (popLocal(index, task) || steal(index, task)) {
+            pending.fetch_sub(1);
+            return true;
+        }
+        return false;
+    }
+    
+    void workerLoop(size_t index) {
+        currentPool = this;
+        currentIndex = index;
+        function<void()> task;
+        while (true) {
+            if (findTask(index, task)) {
+                task();
+                task = nullptr;
+                continue;
+            }
+            unique_lock<mutex> lock(sleepMutex);
+            sleepers.fetch_add(1);
+            wakeUp.wait(lock, [this]() { return stopping.load() || pending.load() > 0; });
+            sleepers.fetch_sub(1);
+            if (stopping.load() && pending.load() == 0) return;
+        }
+    }
+    
+public:
+    explicit ThreadPool(size_t threadCount = thread::hardware_concurrency()) {
+        if (threadCount == 0) threadCount = 1;
+        for (size_t i = 0; i < threadCount; i++) {
+            queues.push_back(make_unique<WorkQueue>());
+        }
+        for (size_t i = 0; i < threadCount; i++) {
+            workers.emplace_back(&ThreadPool::workerLoop, this, i);
+        }
+    }
+    
+    // Runs every task already submitted, then joins the workers
+    ~ThreadPool() {
+        {
+            lock_guard<mutex> lock(sleepMutex);
+            stopping = true;
+        }
+        wakeUp.notify_all();
+        for (auto& worker : workers) {
+            worker.join();
+        }
+    }
+    
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+    
+    size_t size() const { return workers.size(); }
+    
+    template<typename F, typename... Args>
+    auto submit(F&& f, Args&&... args) -> future<invoke_result_t<F, Args...>> {
+        using R = invoke_result_t<F, Args...>;
+        auto task = make_shared<packaged_task<R()>>(
+            bind(forward<F>(f), forward<Args>(args)...));
+        future<R> result = task->get_future();
+        enqueue([task]() { (*task)(); });
+        return result;
+    }
+    
+    // Runs one queued task on the calling thread; used to help while waiting
+    bool runPendingTask() {
+        function<void()> task;
+        size_t index = (currentPool == this) ? currentIndex : 0;
+        if (!findTask(index, task)) return false;
+        task();
+        return true;
+    }
+    
+    // Calls body(i) for every i in [begin, end), split into chunks of `grain`.
+    // The caller helps run chunks, so this is safe to call from a pool task.
+    template<typename F>
+    void parallelFor(size_t begin, size_t end, F&& body, size_t grain = 0) {
+        if (begin >= end) return;
+        size_t count = end - begin;
+        if (grain == 0) {
+            grain = max<size_t>(1, count / (size() * 4));
+        }
+        size_t chunks = (count + grain - 1) / grain;
+        if (chunks == 1) {
+            for (size_t i = begin; i < end; i++) body(i);
+            return;
+        }
+        
+        atomic<size_t> remaining{chunks};
+        exception_ptr error;
+        mutex errorMutex;
+        for (size_t c = 0; c < chunks; c++) {
+            size_t from = begin + c * grain;
+            size_t to = min(end, from + grain);
+            enqueue([&, from, to]() {
+                try {
+                    for (size_t i = from; i < to; i++) body(i);
+                } catch (...) {
+                    lock_guard<mutex> lock(errorMutex);
+                    if (!error) error = current_exception();
+                }
+                remaining.fetch_sub(1, memory_order_release);
+            });
+        }
+        while (remaining.load(memory_order_acquire) > 0) {
+            if (!runPendingTask()) this_thread::yield();
+        }
+        if (error) rethrow_exception(error);
+    }
+};
+
+thread_local ThreadPool* ThreadPool::currentPool = nullptr;
+thread_local size_t ThreadPool::currentIndex = 0;
+
+// Shared pool for code that does not need its own
+ThreadPool& defaultThreadPool() {
+    static ThreadPool pool;
+    return pool;
+}
+
+// Parallel sorting on the pool
+// LSD radix sort for integer keys: each pass counts one byte per block in
+// parallel, turns the counts into per-block output offsets, then scatters.
+template<typename T>
+void parallelRadixSort(vector<T>& keys, ThreadPool& pool = defaultThreadPool()) {
+    static_assert(is_integral<T>::value, "parallelRadixSort needs integer keys");
+    using U = make_unsigned_t<T>;
+    // Flipping the sign bit makes signed keys sort correctly as unsigned
+    const U flip = is_signed<T>::value ? U(U(1) << (sizeof(T) * 8 - 1)) : U(0);
+    
+    size_t n = keys.size();
+    if (n < (1u << 16)) {
+        sort(keys.begin(), keys.end());
+        return;
+    }
+    
+    size_t blocks = min(pool.size() * 4, n / (1u << 14));
+    size_t blockSize = (n + blocks - 1) / blocks;
+    vector<array<size_t, 256>> offsets(blocks);
+    vector<T> buffer(n);
+    T* src = keys.data();
+    T* dst = buffer.data();
+    
+    for (unsigned shift = 0; shift < sizeof(T) * 8; shift += 8) {
+        auto digit = [flip, shift](T key) { return ((U(key) ^ flip) >> shift) & 0xFF; };
+        
+        pool.parallelFor(0, blocks, [&](size_t b) {
+            auto& counts = offsets[b];
+            counts.fill(0);
+            for (size_t i = b * blockSize, end = min(n, i + blockSize); i < end; i++) {
+                counts[digit(src[i])]++;
+            }
+        }, 1);
+        
+        // A byte shared by every key does not change the order
+        size_t firstDigitTotal = 0;
+        for (size_t b = 0; b < blocks; b++) firstDigitTotal += offsets[b][digit(src[0])];
+        if (firstDigitTotal == n) continue;
+        
+        size_t total = 0;
+        for (size_t d = 0; d < 256; d++) {
+            for (size_t b = 0; b < blocks; b++) {
+                size_t count = offsets[b][d];
+                offsets[b][d] = total;
+                total += count;
+            }
+        }
+        
+        pool.parallelFor(0, blocks, [&](size_t b) {
+            auto& next = offsets[b];
+            for (size_t i = b * blockSize, end = min(n, i + blockSize); i < end; i++) {
+                dst[next[digit(src[i])]++] = src[i];
+            }
+        }, 1);
+        swap(src, dst);
+    }
+    
+    if (src != keys.data()) {
+        keys.swap(buffer);
+    }
+}
+
+// Stable merge sort for any comparator: sort one run per chunk in parallel,
+// then merge neighbouring runs pairwise until one is left.
+// T must be default-constructible and movable.
+template<typename T, typename Compare = less<T>>
+void parallelMergeSort(vector<T>& data, Compare comp = Compare(),
+                       ThreadPool& pool = defaultThreadPool()) {
+    size_t n = data.size();
+    size_t chunks = min(pool.size() * 2, n / (1u << 13));
+    if (chunks < 2) {
+        stable_sort(data.begin(), data.end(), comp);
+        return;
+    }
+    
+    vector<size_t> bounds;
+    for (size_t c = 0; c <= chunks; c++) bounds.push_back(n * c / chunks);
+    
+    pool.parallelFor(0, chunks, [&](size_t c) {
+        stable_sort(data.begin() + bounds[c], data.begin() + bounds[c + 1], comp);
+    }, 1);
+    
+    vector<T> buffer(n);
+    vector<T>* src = &data;
+    vector<T>* dst = &buffer;
+    while (bounds.size() > 2) {
+        size_t runs = bounds.size() - 1;
+        pool.parallelFor(0, (runs + 1) / 2, [&](size_t p) {
+            auto in = src->begin();
+            auto out = dst->begin();
+            size_t lo = bounds[2 * p], mid = bounds[min(2 * p + 1, runs)], hi = bounds[min(2 * p + 2, runs)];
+            merge(make_move_iterator(in + lo), make_move_iterator(in + mid),
+                  make_move_iterator(in + mid), make_move_iterator(in + hi),
+                  out + lo, comp);
+        }, 1);
+        
+        vector<size_t> merged;
+        for (size_t i = 0; i < bounds.size(); i += 2) merged.push_back(bounds[i]);
+        if (merged.back() != n) merged.push_back(n);
+        bounds.swap(merged);
+        swap(src, dst);
+    }
+    
+    if (src != &data) {
+        data.swap(buffer);
+    }
+}
+
+// Lock-free stack
+// Treiber stack: push and pop swing the head pointer with compare-exchange.
+// A popped node may still be read by another thread that loaded the old
+// head, so nodes are retired through hazard pointers instead of deleted
+// straight away. This also rules out ABA: an address cannot be reused while
+// any thread has it published as hazardous.
+class HazardPointers {
+private:
+    static constexpr size_t MAX_THREADS = 256;
+    static constexpr size_t SLOTS_PER_THREAD = 4;  // How deeply guards may nest
+    static constexpr size_t SCAN_THRESHOLD = 2 * MAX_THREADS * SLOTS_PER_THREAD;
+    
+    struct alignas(CACHE_LINE_SIZE) Record {
+        atomic<bool> owned{false};
+        atomic<const void*> pointers[SLOTS_PER_THREAD] = {};
+    };
+    
+    struct Retired {
+        void* pointer;
+        void (*deleter)(void*);
+    };
+    
+    struct ThreadState {
+        HazardPointers& domain;
+        Record* record = nullptr;
+        size_t slotsInUse = 0;
+        vector<Retired> retired;
+        
+        explicit ThreadState(HazardPointers& d) : domain(d) {
+            for (auto& candidate : domain.records) {
+                bool expected = false;
+                if (candidate.owned.compare_exchange_strong(expected, true)) {
+                    record = &candidate;
+                    return;
+                }
+            }
+            throw runtime_error("Too many threads using hazard pointers");
+        }
+        
+        // Whatever is still protected elsewhere is left for a later scan
+        ~ThreadState() {
+            domain.scan(retired);
+            if (!retired.empty()) {
+                lock_guard<mutex> lock(domain.orphanMutex);
+                domain.orphans.insert(domain.orphans.end(), retired.begin(), retired.end());
+            }
+            record->owned.store(false);
+        }
+    };
+    
+    Record records[MAX_THREADS];
+    mutex orphanMutex;
+    vector<Retired> orphans;  // Left behind by threads that exited
+    
+    ThreadState& local() {
+        thread_local ThreadState state(*this);
+        return state;
+    }
+    
+    // Frees every retired pointer no thread currently protects
+    void scan(vector<Retired>& retired) {
+        {
+            unique_lock<mutex> lock(orphanMutex, try_to_lock);
+            if (lock.owns_lock() && !orphans.empty()) {
+                retired.insert(retired.end(), orphans.begin(), orphans.end());
+                orphans.clear();
+            }
+        }
+        vector<const void*> protectedPointers;
+        for (auto& record : records) {
+            for (auto& slot : record.pointers) {
+                if (const void* p = slot.load()) protectedPointers.push_back(p);
+            }
+        }
+        sort(protectedPointers.begin(), protectedPointers.end());
+        
+        size_t kept = 0;
+        for (auto& r : retired) {
+            if (binary_search(protectedPointers.begin(), protectedPointers.end(), r.pointer)) {
+                retired[kept++] = r;
+            } else {
+                r.deleter(r.pointer);
+            }
+        }
+        retired.resize(kept);
+    }
+    
+public:
+    // Claims one of this thread's slots for its lifetime; guards must be
+    // released in reverse order, which scoping gives for free
+    class Guard {
+    private:
+        atomic<const void*>* slot;
+        
+    public:
+        Guard() {
+            ThreadState& state = HazardPointers::instance().local();
+            if (state.slotsInUse == SLOTS_PER_THREAD) {
+                throw runtime_error("Hazard pointer guards nested too deeply");
+            }
+            slot = &state.record->pointers[state.slotsInUse++];
+        }
+        
+        ~Guard() {
+            slot->store(nullptr, memory_order_release);
+            HazardPointers::instance().local().slotsInUse--;
+        }
+        
+        Guard(const Guard&) = delete;
+        Guard& operator=(const Guard&) = delete;
+        
+        // Publishes the value of `source` as in use and returns it;
+        // re-reads until the published value is still current
+        template<typename T>
+        T* protect(const atomic<T*>& source) {
+            T* p = source.load();
+            while (true) {
+                slot->store(p);
+                T* again = source.load();
+                if (again == p) return p;
+                p = again;
+            }
+        }
+        
+        void reset() { slot->store(nullptr, memory_order_release); }
+    };
+    
+    ~HazardPointers() {
+        for (auto& r : orphans) r.deleter(r.pointer);
+    }
+    
+    static HazardPointers& instance() {
+        static HazardPointers domain;
+        return domain;
+    }
+    
+    // True while any thread has p published
+    bool isProtected(const void* p) const {
+        for (auto& record : records) {
+            for (auto& slot : record.pointers) {
+                if (slot.load() == p) return true;
+            }
+        }
+        return false;
+    }
+    
+    template<typename T>
+    void retire(T* p) {
+        ThreadState& state = local();
+        state.retired.push_back({p, [](void* q) { delete static_cast<T*>(q); }});
+        if (state.retired.size() >= SCAN_THRESHOLD) {
+            scan(state.retired);
+        }
+    }
+};
+
+template<typename T>
+class ConcurrentStack {
+private:
+    struct Node {
+        T value;
+        Node* next = nullptr;
+        atomic<uint32_t> readers{0};  // tryTop() calls copying value right now
+        
+        template<typename... Args>
+        explicit Node(Args&&... args) : value(forward<Args>(args)...) {}
+    };
+    
+    atomic<Node*> head{nullptr};
+    
+    void pushNode(Node* node) {
+        node->next = head.load(memory_order_relaxed);
+        while (!head.compare_exchange_weak(node->next, node,
+                                           memory_order_release, memory_order_relaxed)) {
+        }
+    }
+    
+public:
+    ConcurrentStack() = default;
+    ConcurrentStack(const ConcurrentStack&) = delete;
+    ConcurrentStack& operator=(const ConcurrentStack&) = delete;
+    
+    // Not safe while other threads still use the stack
+    ~ConcurrentStack() {
+        Node* node = head.load();
+        while (node != nullptr) {
+            Node* next = node->next;
+            delete node;
+            node = next;
+        }
+    }
+    
+    void push(const T& element) { pushNode(new Node(element)); }
+    void push(T&& element) { pushNode(new Node(move(element))); }
+    
+    template<typename... Args>
+    void emplace(Args&&... args) { pushNode(new Node(forward<Args>(args)...)); }
+    
+    optional<T> tryPop() {
+        Node* node;
+        {
+            HazardPointers::Guard guard;
+            while (true) {
+                node = guard.protect(head);
+                if (node == nullptr) return nullopt;
+                // node->next is safe to read: node cannot be freed while protected
+                if (head.compare_exchange_strong(node, node->next,
+                                                 memory_order_seq_cst, memory_order_relaxed)) {
+                    break;
+                }
+            }
+        }
+        
+        // A tryTop() that registered before the node left the stack may still
+        // be copying the value; once they finish, no new one can start
+        while (node->readers.load(memory_order_seq_cst) != 0) {
+            this_thread::yield();
+        }
+        optional<T> value(move(node->value));
+        HazardPointers::instance().retire(node);
+        return value;
+    }
+    
+    T pop() {
+        optional<T> value = tryPop();
+        if (!value) {
+            throw runtime_error("Stack is empty");
+        }
+        return move(*value);
+    }
+    
+    // A copy of the current top; it may already be popped by the time it returns.
+    // Registers as a reader, then checks the node is still on top: either
+    // tryPop() sees the registration and waits, or we see the pop and retry.
+    optional<T> tryTop() const {
+        HazardPointers::Guard guard;
+        while (true) {
+            Node* node = guard.protect(head);
+            if (node == nullptr) return nullopt;
+            node->readers.fetch_add(1, memory_order_seq_cst);
+            if (head.load(memory_order_seq_cst) != node) {
+                node->readers.fetch_sub(1, memory_order_release);
+                continue;
+            }
+            optional<T> value(node->value);
+            node->readers.fetch_sub(1, memory_order_release);
+            return value;
+        }
+    }
+    
+    T top() const {
+        optional<T> value = tryTop();
+        if (!value) {
+            throw runtime_error("Stack is empty");
+        }
+        return move(*value);
+    }
+    
+    bool empty() const {
+        return head.load(memory_order_acquire) == nullptr;
+    }
+};
+
+// Bounded lock-free queue
+// Fixed ring of cells, each with a sequence number that says whose turn it
+// is (Vyukov's bounded MPMC queue). Producers and consumers claim slots with
+// one compare-exchange on their own index and never touch each other's.
+template<typename T>
+class BoundedQueue {
+public:
+    using value_type = T;
+    
+private:
+    struct Cell {
+        atomic<size_t> sequence;
+        T value;
+    };
+    
+    unique_ptr<Cell[]> cells;
+    size_t mask;
+    alignas(CACHE_LINE_SIZE) atomic<size_t> enqueuePos{0};
+    alignas(CACHE_LINE_SIZE) atomic<size_t> dequeuePos{0};
+    
+public:
+    // Capacity is rounded up to a power of two
+    explicit BoundedQueue(size_t capacity) {
+        size_t size = 2;
+        while (size < capacity) size *= 2;
+        cells.reset(new Cell[size]);
+        mask = size - 1;
+        for (size_t i = 0; i < size; i++) {
+            cells[i].sequence.store(i, memory_order_relaxed);
+        }
+    }
+    
+    BoundedQueue(const BoundedQueue&) = delete;
+    BoundedQueue& operator=(const BoundedQueue&) = delete;
+    
+    template<typename U>
+    bool tryPush(U&& value) {
+        size_t pos = enqueuePos.load(memory_order_relaxed);
+        while (true) {
+            Cell& cell = cells[pos & mask];
+            size_t seq = cell.sequence.load(memory_order_acquire);
+            intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos);
+            if (diff == 0) {
+                if (enqueuePos.compare_exchange_weak(pos, pos + 1, memory_order_relaxed)) {
+                    cell.value = forward<U>(value);
+                    cell.sequence.store(pos + 1, memory_order_release);
+                    return true;
+                }
+            } else if (diff < 0) {
+                return false;  // Full
+            } else {
+                pos = enqueuePos.load(memory_order_relaxed);
+            }
+        }
+    }
+    
+    bool tryPop(T& out) {
+        size_t pos = dequeuePos.load(memory_order_relaxed);
+        while (true) {
+            Cell& cell = cells[pos & mask];
+            size_t seq = cell.sequence.load(memory_order_acquire);
+            intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos + 1);
+            if (diff == 0) {
+                if (dequeuePos.compare_exchange_weak(pos, pos + 1, memory_order_relaxed)) {
+                    out = move(cell.value);
+                    cell.sequence.store(pos + mask + 1, memory_order_release);
+                    return true;
+                }
+            } else if (diff < 0) {
+                return false;  // Empty
+            } else {
+                pos = dequeuePos.load(memory_order_relaxed);
+            }
+        }
+    }
+    
+    // Claims the run of free cells at the tail with one compare-exchange;
+    // returns how many values went in (0 when full)
+    size_t tryPushBatch(span<const T> values) {
+        size_t pos = enqueuePos.load(memory_order_relaxed);
+        while (!values.empty()) {
+            size_t n = 0;
+            while (n < values.size() && n <= mask &&
+                   cells[(pos + n) & mask].sequence.load(memory_order_acquire) == pos + n) {
+                n++;
+            }
+            if (n == 0) {
+                size_t seq = cells[pos & mask].sequence.load(memory_order_acquire);
+                if (static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos) < 0) return 0;  // Full
+                pos = enqueuePos.load(memory_order_relaxed);
+                continue;
+            }
+            if (enqueuePos.compare_exchange_weak(pos, pos + n, memory_order_relaxed)) {
+                for (size_t i = 0; i < n; i++) {
+                    Cell& cell = cells[(pos + i) & mask];
+                    cell.value = values[i];
+                    cell.sequence.store(pos + i + 1, memory_order_release);
+                }
+                return n;
+            }
+        }
+        return 0;
+    }
+    
+    // Takes up to out.size() ready values from the head in one claim
+    size_t tryPopBatch(span<T> out) {
+        size_t pos = dequeuePos.load(memory_order_relaxed);
+        while (!out.empty()) {
+            size_t n = 0;
+            while (n < out.size() && n <= mask &&
+                   cells[(pos + n) & mask].sequence.load(memory_order_acquire) == pos + n + 1) {
+                n++;
+            }
+            if (n == 0) {
+                size_t seq = cells[pos & mask].sequence.load(memory_order_acquire);
+                if (static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos + 1) < 0) return 0;  // Empty
+                pos = dequeuePos.load(memory_order_relaxed);
+                continue;
+            }
+            if (dequeuePos.compare_exchange_weak(pos, pos + n, memory_order_relaxed)) {
+                for (size_t i = 0; i < n; i++) {
+                    Cell& cell = cells[(pos + i) & mask];
+                    out[i] = move(cell.value);
+                    cell.sequence.store(pos + i + mask + 1, memory_order_release);
+                }
+                return n;
+            }
+        }
+        return 0;
+    }
+    
+    size_t capacity() const { return mask + 1; }
+    
+    // Only a snapshot while other threads are active
+    size_t sizeApprox() const {
+        size_t head = dequeuePos.load(memory_order_relaxed);
+        size_t tail = enqueuePos.load(memory_order_relaxed);
+        return tail > head ? tail - head : 0;
+    }
+};
+
+// Single-producer single-consumer ring
+// With one thread on each side no compare-exchange is needed: each side
+// owns its index and publishes it with a release store. The indices sit on
+// separate cache lines, and each side keeps a cached copy of the other's
+// index next to its own, so it only reads the shared line when the cached
+// value says the ring looks full (or empty).
+template<typename T>
+class SpscQueue {
+public:
+    using value_type = T;
+    
+private:
+    unique_ptr<T[]> slots;
+    size_t mask;
+    
+    // Producer's line
+    alignas(CACHE_LINE_SIZE) atomic<size_t> tail{0};
+    size_t cachedHead = 0;
+    
+    // Consumer's line
+    alignas(CACHE_LINE_SIZE) atomic<size_t> head{0};
+    size_t cachedTail = 0;
+    
+    // Free slots seen by the producer, rereading head only when short
+    size_t room(size_t t, size_t wanted) {
+        size_t free = capacity() - (t - cachedHead);
+        if (free < wanted) {
+            cachedHead = head.load(memory_order_acquire);
+            free = capacity() - (t - cachedHead);
+        }
+        return free;
+    }
+    
+    // Filled slots seen by the consumer, rereading tail only when short
+    size_t ready(size_t h, size_t wanted) {
+        size_t filled = cachedTail - h;
+        if (filled < wanted) {
+            cachedTail = tail.load(memory_order_acquire);
+            filled = cachedTail - h;
+        }
+        return filled;
+    }
+    
+public:
+    // Capacity is rounded up to a power of two
+    explicit SpscQueue(size_t capacity) {
+        size_t size = 2;
+        while (size < capacity) size *= 2;
+        slots.reset(new T[size]);
+        mask = size - 1;
+    }
+    
+    SpscQueue(const SpscQueue&) = delete;
+    SpscQueue& operator=(const SpscQueue&) = delete;
+    
+    // Producer thread only
+    template<typename U>
+    bool tryPush(U&& value) {
+        size_t t = tail.load(memory_order_relaxed);
+        if (room(t, 1) == 0) return false;
+        slots[t & mask] = forward<U>(value);
+        tail.store(t + 1, memory_order_release);
+        return true;
+    }
+    
+    size_t tryPushBatch(span<const T> values) {
+        size_t t = tail.load(memory_order_relaxed);
+        size_t n = min(room(t, values.size()), values.size());
+        for (size_t i = 0; i < n; i++) {
+            slots[(t + i) & mask] = values[i];
+        }
+        tail.store(t + n, memory_order_release);
+        return n;
+    }
+    
+    // Consumer thread only
+    bool tryPop(T& out) {
+        size_t h = head.load(memory_order_relaxed);
+        if (ready(h, 1) == 0) return false;
+        out = move(slots[h & mask]);
+        head.store(h + 1, memory_order_release);
+        return true;
+    }
+    
+    size_t tryPopBatch(span<T> out) {
+        size_t h = head.load(memory_order_relaxed);
+        size_t n = min(ready(h, out.size()), out.size());
+        for (size_t i = 0; i < n; i++) {
+            out[i] = move(slots[(h + i) & mask]);
+        }
+        head.store(h + n, memory_order_release);
+        return n;
+    }
+    
+    size_t capacity() const { return mask + 1; }
+    
+    size_t sizeApprox() const {
+        return tail.load(memory_order_relaxed) - head.load(memory_order_relaxed);
+    }
+};
+
+// Spin-wait hint: lets the sibling hyperthread run while we poll
+inline void cpuRelax() {
+#if GUIDE_X86_SIMD
+    _mm_pause();
+#else
+    this_thread::yield();
+#endif
+}
+
+// Blocking wrapper for SpscQueue or BoundedQueue
+// push()/pop() retry for a short spin, then sleep with atomic::wait, which
+// is a futex on Linux. A sleeper raises a flag and then retries once more;
+// the other side only bumps the epoch and notifies when it finds the flag
+// raised, and clears it as it does, so a busy queue makes no system calls
+// and a sleeper costs one wake-up, not one per message.
+template<typename Queue>
+class BlockingQueue {
+public:
+    using value_type = typename Queue::value_type;
+    
+private:
+    static constexpr int SPIN_LIMIT = 128;
+    
+    Queue queue;
+    
+    // Consumers sleep on pushEpoch, producers on popEpoch
+    alignas(CACHE_LINE_SIZE) atomic<uint32_t> pushEpoch{0};
+    atomic<bool> consumersAsleep{false};
+    alignas(CACHE_LINE_SIZE) atomic<uint32_t> popEpoch{0};
+    atomic<bool> producersAsleep{false};
+    
+    // Runs attempt() until it returns nonzero, sleeping between tries
+    template<typename Attempt>
+    static auto retry(Attempt attempt, atomic<uint32_t>& epoch, atomic<bool>& asleep) {
+        for (int i = 0; i < SPIN_LIMIT; i++) {
+            if (auto done = attempt()) return done;
+            cpuRelax();
+        }
+        while (true) {
+            uint32_t seen = epoch.load(memory_order_acquire);
+            asleep.store(true, memory_order_relaxed);
+            atomic_thread_fence(memory_order_seq_cst);
+            if (auto done = attempt()) return done;  // A stale flag costs one extra notify
+            epoch.wait(seen, memory_order_acquire);
+        }
+    }
+    
+    // Called after a successful push or pop. Every sleeper is woken because
+    // the flag does not say how many there are.
+    static void wake(atomic<uint32_t>& epoch, atomic<bool>& asleep) {
+        atomic_thread_fence(memory_order_seq_cst);
+        if (!asleep.load(memory_order_relaxed) || !asleep.exchange(false, memory_order_relaxed)) return;
+        epoch.fetch_add(1, memory_order_release);
+        epoch.notify_all();
+    }
+    
+public:
+    explicit BlockingQueue(size_t capacity) : queue(capacity) {}
+    
+    template<typename U>
+    void push(U&& value) {
+        retry([&]() { return queue.tryPush(forward<U>(value)); }, popEpoch, producersAsleep);
+        wake(pushEpoch, consumersAsleep);
+    }
+    
+    value_type pop() {
+        value_type value;
+        retry([&]() { return queue.tryPop(value); }, pushEpoch, consumersAsleep);
+        wake(popEpoch, producersAsleep);
+        return value;
+    }
+    
+    // Returns once every value is in, waking consumers after each chunk
+    void pushBatch(span<const value_type> values) {
+        while (!values.empty()) {
+            size_t n = retry([&]() { return queue.tryPushBatch(values); }, popEpoch, producersAsleep);
+            wake(pushEpoch, consumersAsleep);
+            values = values.subspan(n);
+        }
+    }
+    
+    // Waits for at least one value; returns how many were written to out
+    size_t popBatch(span<value_type> out) {
+        size_t n = retry([&]() { return queue.tryPopBatch(out); }, pushEpoch, consumersAsleep);
+        wake(popEpoch, producersAsleep);
+        return n;
+    }
+    
+    size_t capacity() const { return queue.capacity(); }
+    size_t sizeApprox() const { return queue.sizeApprox(); }
+};
+
+void multithreading() {
+    cout << "\n=== MULTITHREADING ===" << endl;
+    
+    // Basic thread creation
+    thread t1(workerFunction, 1);
+    thread t2(workerFunction, 2);
+    
+    t1.join();  // Wait for thread to complete
+    t2.join();
+    
+    // The rest of the section reuses a fixed set of worker threads
+    ThreadPool pool(max(2u, thread::hardware_concurrency()));
+    cout << "Thread pool with " << pool.size() << " workers" << endl;
+    
+    // Thread synchronization with mutex
+    sharedCounter = 0;  // Reset counter
+    future<void> inc1 = pool.submit(incrementCounter, 1);
+    future<void> inc2 = pool.submit(incrementCounter, 2);
+    
+    inc1.get();  // Wait for task to complete
+    inc2.get();
+    
+    cout << "Final counter value: " << sharedCounter << endl;
+    
+    // Same work without a lock: one shared atomic, then per-thread shards
+    atomicCounter = 0;
+    future<void> at1 = pool.submit(incrementAtomicCounter, 1);
+    future<void> at2 = pool.submit(incrementAtomicCounter, 2);
+    at1.get();
+    at2.get();
+    cout << "Atomic counter value: " << atomicCounter << endl;
+    
+    shardedCounter.reset();
+    future<void> sh1 = pool.submit(incrementShardedCounter, 1);
+    future<void> sh2 = pool.submit(incrementShardedCounter, 2);
+    sh1.get();
+    sh2.get();
+    cout << "Sharded counter value: " << shardedCounter.load()
+         << " (" << shardedCounter.shardCount() << " shards)" << endl;
+    
+    // Parallel loop over the pool
+    vector<int> squares(8);
+    pool.parallelFor(0, squares.size(), [&squares](size_t i) {
+        squares[i] = static_cast<int>(i * i);
+    });
+    cout << "parallelFor squares: ";
+    for (int sq : squares) cout << sq << " ";
+    cout << endl;
+    
+    // Parallel sorts: radix for integer keys, merge sort for any comparator
+    vector<int> keys = {64, -34, 25, 12, -22, 11, 90};
+    parallelRadixSort(keys, pool);
+    vector<string> words = {"pear", "fig", "apple", "kiwi"};
+    parallelMergeSort(words, [](const string& a, const string& b) { return a.size() < b.size(); }, pool);
+    // Lock-free stack shared by producer and consumer tasks
+    ConcurrentStack<int> sharedStack;
+    pool.parallelFor(0, 100, [&sharedStack](size_t i) { sharedStack.push(static_cast<int>(i)); });
+    atomic<int> poppedSum{0};
+    pool.parallelFor(0, 100, [&](size_t) {
+        if (auto value = sharedStack.tryPop()) poppedSum += *value;
+    });
+    cout << "ConcurrentStack popped sum: " << poppedSum << " (expected 4950), empty: "
+         << boolalpha << sharedStack.empty() << endl;
+    
+    // Producer/consumer handoff through a blocking SPSC ring; 0 ends the stream
+    BlockingQueue<SpscQueue<int>> handoff(64);
+    thread producer([&handoff]() {
+        for (int i = 1; i <= 1000; i++) handoff.push(i);
+        handoff.push(0);
+    });
+    long long handoffSum = 0;
+    for (int value = handoff.pop(); value != 0; value = handoff.pop()) handoffSum += value;
+    producer.join();
+    cout << "SPSC handoff sum: " << handoffSum << " (expected 500500)" << endl;
+    
+    cout << "Radix sorted: ";
+    for (int k : keys) cout << k << " ";
+    cout << endl << "Merge sorted by length: ";
+    for (const auto& w : words) cout << w << " ";
+    cout << endl;
+    
+    // Async and futures: submit() hands back a future like async() does
+    future<int> result = pool.submit(calculateSquare, 5);
+    cout << "Calculating square asynchronously..." << endl;
+    
+    // Do other work while calculation runs
+    this_thread::sleep_for(chrono::milliseconds(500));
+    cout << "Doing other work..." << endl;
+    
+    // Get result (will wait if not ready)
+    int square = result.get();
+    cout << "Square result: " << square << endl;
+    
+    // Promise and future
+    promise<string> prom;
+    future<string> fut = prom.get_future();
+    
+    pool.submit([&prom]() {
+        this_thread::sleep_for(chrono::milliseconds(1000));
+        prom.set_value("Hello from promise!");
+    });
+    
+    cout << "Waiting for promise..." << endl;
+    cout << "Promise result: " << fut.get() << endl;
+}
+
+/*
+===============================================================================
+                            14. MODERN C++ FEATURES
+===============================================================================
+*/
+
+// 14.1 Move Semantics and Perfect Forwarding
+// Size-Class Buffer Pool
+// Recycles freed buffers instead of handing them back to the allocator.
+// Requests round up to a power of two (64 B .. 1 MiB). Each thread keeps a
+// short free list per size class, so the common path takes no lock; when
+// a list overflows, or its thread exits, blocks move to a shared list that
+// other threads refill from. Larger requests go straight to operator new.
+class BufferPool {
+public:
+    struct Stats {
+        uint64_t requests = 0;          // allocate() calls
+        uint64_t threadHits = 0;        // Served from the caller's free list
+        uint64_t sharedHits = 0;        // Refilled from the shared list
+        uint64_t heapAllocations = 0;   // Had to call operator new
+        
+        uint64_t saved() const { return threadHits + sharedHits; }
+    };
+    
+private:
+    static constexpr size_t MIN_SHIFT = 6;
+    static constexpr size_t CLASSES = 15;
+    static constexpr size_t LOCAL_LIMIT = 64;   // Blocks per class per thread
+    static constexpr size_t REFILL = 16;        // Blocks taken from the shared list at once
+    
+    struct FreeBlock {
+        FreeBlock* next;
+    };
+    
+    struct FreeList {
+        FreeBlock* head = nullptr;
+        size_t count = 0;
+        
+        void push(void* p) {
+            FreeBlock* block = static_cast<FreeBlock*>(p);
+            block->next = head;
+            head = block;
+            count++;
+        }
+        
+        void* pop() {
+            FreeBlock* block = head;
+            head = block->next;
+            count--;
+            return block;
+        }
+    };
+    
+    // Written only by the owning thread; relaxed atomics let stats() read them
+    struct Counters {
+        atomic<uint64_t> requests{0};
+        atomic<uint64_t> threadHits{0};
+        atomic<uint64_t> sharedHits{0};
+        atomic<uint64_t> heapAllocations{0};
+        
+        static void bump(atomic<uint64_t>& c) {
+            c.store(c.load(memory_order_relaxed) + 1, memory_order_relaxed);
+        }
+        
+        void addTo(Stats& stats) const {
+            stats.requests += requests.load(memory_order_relaxed);
+            stats.threadHits += threadHits.load(memory_order_relaxed);
+            stats.sharedHits += sharedHits.load(memory_order_relaxed);
+            stats.heapAllocations += heapAllocations.load(memory_order_relaxed);
+        }
+    };
+    
+    struct ThreadCache;
+    
+    struct Shared {
+        mutex lock;
+        array<FreeList, CLASSES> lists;
+        vector<ThreadCache*> caches;
+        Stats retired;                  // Totals of threads that have exited
+        
+        ~Shared() {
+            for (auto& list : lists) {
+                while (list.head != nullptr) {
+                    ::operator delete(list.pop());
+                }
+            }
+        }
+    };
+    
+    struct ThreadCache {
+        array<FreeList, CLASSES> lists;
+        Counters counters;
+        
+        ThreadCache() {
+            Shared& s = shared();
+            lock_guard<mutex> guard(s.lock);
+            s.caches.push_back(this);
+        }
+        
+        ~ThreadCache() {
+            Shared& s = shared();
+            lock_guard<mutex> guard(s.lock);
+            for (size_t c = 0; c < CLASSES; c++) {
+                while (lists[c].head != nullptr) {
+                    s.lists[c].push(lists[c].pop());
+                }
+            }
+            counters.addTo(s.retired);
+            s.caches.erase(find(s.caches.begin(), s.caches.end(), this));
+            cacheDestroyed() = true;
+        }
+    };
+    
+    static Shared& shared() {
+        static Shared instance;
+        return instance;
+    }
+    
+    // Stays readable after the cache itself is gone (thread or process exit)
+    static bool& cacheDestroyed() {
+        thread_local bool destroyed = false;
+        return destroyed;
+    }
+    
+    static ThreadCache* cache() {
+        if (cacheDestroyed()) return nullptr;
+        thread_local ThreadCache instance;
+        return &instance;
+    }
+    
+    static size_t classFor(size_t bytes) {
+        if (bytes <= (size_t(1) << MIN_SHIFT)) return 0;
+        return bit_width(bytes - 1) - MIN_SHIFT;
+    }
+    
+    static size_t classBytes(size_t sizeClass) {
+        return size_t(1) << (sizeClass + MIN_SHIFT);
+    }
+    
+public:
+    static void* allocate(size_t bytes) {
+        size_t sizeClass = classFor(bytes);
+        ThreadCache* local = cache();
+        if (local != nullptr) Counters::bump(local->counters.requests);
+        if (sizeClass >= CLASSES) {
+            if (local != nullptr) Counters::bump(local->counters.heapAllocations);
+            return ::operator new(bytes);
+        }
+        
+        if (local != nullptr) {
+            FreeList& list = local->lists[sizeClass];
+            if (list.head != nullptr) {
+                Counters::bump(local->counters.threadHits);
+                return list.pop();
+            }
+        }
+        
+        {
+            Shared& s = shared();
+            lock_guard<mutex> guard(s.lock);
+            FreeList& sharedList = s.lists[sizeClass];
+            if (sharedList.head != nullptr) {
+                void* block = sharedList.pop();
+                if (local != nullptr) {
+                    Counters::bump(local->counters.sharedHits);
+                    for (size_t i = 1; i < REFILL && sharedList.head != nullptr; i++) {
+                        local->lists[sizeClass].push(sharedList.pop());
+                    }
+                }
+                return block;
+            }
+        }
+        
+        if (local != nullptr) Counters::bump(local->counters.heapAllocations);
+        return ::operator new(classBytes(sizeClass));
+    }
+    
+    // bytes must match the size passed to allocate()
+    static void deallocate(void* p, size_t bytes) {
+        if (p == nullptr) return;
+        size_t sizeClass = classFor(bytes);
+        if (sizeClass >= CLASSES) {
+            ::operator delete(p);
+            return;
+        }
+        
+        ThreadCache* local = cache();
+        if (local != nullptr && local->lists[sizeClass].count < LOCAL_LIMIT) {
+            local->lists[sizeClass].push(p);
+            return;
+        }
+        
+        // Full (or no cache): hand half the local list over with this block
+        Shared& s = shared();
+        lock_guard<mutex> guard(s.lock);
+        s.lists[sizeClass].push(p);
+        if (local != nullptr) {
+            for (size_t i = 0; i < LOCAL_LIMIT / 2; i++) {
+                s.lists[sizeClass].push(local->lists[sizeClass].pop());
+            }
+        }
+    }
+    
+    // Totals over live and exited threads; exact once other threads are idle
+    static Stats stats() {
+        Shared& s = shared();
+        lock_guard<mutex> guard(s.lock);
+        Stats total = s.retired;
+        for (const ThreadCache* c : s.caches) {
+            c->counters.addTo(total);
+        }
+        return total;
+    }
+};
+
+// Where MovableClass gets its int buffers from
+struct HeapBuffers {
+    static int* allocate(size_t n) { return new int[n]; }
+    static void deallocate(int* p, size_t) { delete[] p; }
+};
+
+struct PooledBuffers {
+    static int* allocate(size_t n) {
+        return n == 0 ? nullptr : static_cast<int*>(BufferPool::allocate(n * sizeof(int)));
+    }
+    
+    static void deallocate(int* p, size_t n) {
+        BufferPool::deallocate(p, n * sizeof(int));
+    }
+};
+
+template<typename Buffers>
+class BasicMovableClass {
+private:
+    size_t size;
+    int* data;
+    [[no_unique_address]] LifecycleTracker<BasicMovableClass> tracker;
+    
+public:
+    // Lifecycle messages for the demo; benchmarks switch them off
+    static inline bool verbose = true;
+    
+    // Constructor
+    BasicMovableClass(size_t s) : size(s), data(Buffers::allocate(s)) {
+        LifecycleTracker<BasicMovableClass>::allocated(size * sizeof(int));
+        if (verbose) cout << "Constructor: allocated " << size << " elements" << endl;
+        for (size_t i = 0; i < size; i++) {
+            data[i] = static_cast<int>(i);
+        }
+    }
+    
+    // Copy constructor
+    BasicMovableClass(const BasicMovableClass& other)
+        : size(other.size), data(Buffers::allocate(size)), tracker(other.tracker) {
+        LifecycleTracker<BasicMovableClass>::allocated(size * sizeof(int));
+        if (verbose) cout << "Copy constructor called" << endl;
+        copy(other.data, other.data + size, data);
+    }
+    
+    // Move constructor (C++11)
+    BasicMovableClass(BasicMovableClass&& other) noexcept
+        : size(other.size), data(other.data), tracker(move(other.tracker)) {
+        if (verbose) cout << "Move constructor called" << endl;
+        other.data = nullptr;
+        other.size = 0;
+    }
+    
+    // Copy assignment operator
+    BasicMovableClass& operator=(const BasicMovableClass& other) {
+        if (verbose) cout << "Copy assignment called" << endl;
+        if (this != &other) {
+            // Same size: reuse the buffer we already own
+            if (size != other.size) {
+                int* fresh = Buffers::allocate(other.size);
+                LifecycleTracker<BasicMovableClass>::allocated(other.size * sizeof(int));
+                Buffers::deallocate(data, size);
+                data = fresh;
+                size = other.size;
+            }
+            copy(other.data, other.data + size, data);
+            tracker = other.tracker;
+        }
+        return *this;
+    }
+    
+    // Move assignment operator (C++11)
+    BasicMovableClass& operator=(BasicMovableClass&& other) noexcept {
+        if (verbose) cout << "Move assignment called" << endl;
+        if (this != &other) {
+            Buffers::deallocate(data, size);
+            data = other.data;
+            size = other.size;
+            other.data = nullptr;
+            other.size = 0;
+            tracker = move(other.tracker);
+        }
+        return *this;
+    }
+    
+    // Destructor
+    ~BasicMovableClass() {
+        Buffers::deallocate(data, size);
+        if (verbose) cout << "Destructor: freed memory" << endl;
+    }
+    
+    size_t getSize() const { return size; }
+    int* getData() const { return data; }
+};
+
+using MovableClass = BasicMovableClass<PooledBuffers>;
+using HeapMovableClass = BasicMovableClass<HeapBuffers>;
+
+// Small-Buffer-Optimized MovableClass
+// Most instances hold a handful of ints, yet each still costs an allocation.
+// Up to InlineCapacity ints live inside the object itself; only larger
+// sizes spill to the heap. The trade-off shows up in moves: an inline
+// object has no pointer to steal, so moving it copies its elements.
+template<size_t InlineCapacity = 8, typename Buffers = PooledBuffers>
+class SmallMovableClass {
+private:
+    size_t size;
+    union {
+        int inlineData[InlineCapacity];
+        int* heapData;
+    };
+    [[no_unique_address]] LifecycleTracker<SmallMovableClass> tracker;
+    
+    bool isInline() const { return size <= InlineCapacity; }
+    int* data() { return isInline() ? inlineData : heapData; }
+    const int* data() const { return isInline() ? inlineData : heapData; }
+    
+    // Room for n ints in an object that owns no heap buffer yet
+    void allocateFor(size_t n) {
+        size = n;
+        if (!isInline()) {
+            heapData = Buffers::allocate(n);
+            LifecycleTracker<SmallMovableClass>::allocated(n * sizeof(int));
+        }
+    }
+    
+    // Room for n ints, dropping the current contents
+    void resetStorage(size_t n) {
+        int* fresh = n > InlineCapacity ? Buffers::allocate(n) : nullptr;
+        if (fresh != nullptr) LifecycleTracker<SmallMovableClass>::allocated(n * sizeof(int));
+        if (!isInline()) Buffers::deallocate(heapData, size);
+        size = n;
+        if (fresh != nullptr) heapData = fresh;
+    }
+    
+    // Takes other's contents and leaves it empty (inline, size 0)
+    void steal(SmallMovableClass& other) noexcept {
+        size = other.size;
+        if (other.isInline()) {
+            // Whole buffer: a fixed-size copy beats a variable-length one
+            memcpy(inlineData, other.inlineData, sizeof(inlineData));
+        } else {
+            heapData = other.heapData;
+        }
+        other.size = 0;
+    }
+    
+public:
+    static_assert(InlineCapacity > 0, "Use MovableClass for heap-only storage");
+    
+    explicit SmallMovableClass(size_t s) {
+        allocateFor(s);
+        iota(data(), data() + size, 0);
+    }
+    
+    SmallMovableClass(const SmallMovableClass& other) : tracker(other.tracker) {
+        allocateFor(other.size);
+        copy(other.data(), other.data() + size, data());
+    }
+    
+    SmallMovableClass(SmallMovableClass&& other) noexcept : tracker(move(other.tracker)) {
+        steal(other);
+    }
+    
+    SmallMovableClass& operator=(const SmallMovableClass& other) {
+        if (this != &other) {
+            if (size != other.size) resetStorage(other.size);
+            copy(other.data(), other.data() + size, data());
+            tracker = other.tracker;
+        }
+        return *this;
+    }
+    
+    SmallMovableClass& operator=(SmallMovableClass&& other) noexcept {
+        if (this != &other) {
+            if (!isInline()) Buffers::deallocate(heapData, size);
+            steal(other);
+            tracker = move(other.tracker);
+        }
+        return *this;
+    }
+    
+    ~SmallMovableClass() {
+        if (!isInline()) Buffers::deallocate(heapData, size);
+    }
+    
+    size_t getSize() const { return size; }
+    span<int> getData() { return {data(), size}; }
+    span<const int> getData() const { return {data(), size}; }
+    bool usesInlineStorage() const { return isInline(); }
+    static constexpr size_t inlineCapacity() { return InlineCapacity; }
+};
+
+MovableClass createMovableObject() {
+    return MovableClass(5);  // RVO or move
+}
+
+// Evaluated at compile time when its argument is a constant
+constexpr int factorial(int n) {
+    return (n <= 1) ? 1 : n * factorial(n - 1);
+}
+
+// Perfect forwarding example
+template<typename T>
+void wrapper(T&& arg) {
+    // Forward arg to another function while preserving its value category
+    processValue(forward<T>(arg));
+}
+
+void processValue(const int& val) {
+    cout << "Processing lvalue: " << val << endl;
+}
+
+void processValue(int&& val) {
+    cout << "Processing rvalue: " << val << endl;
+}
+
+void modernCppFeatures() {
+    cout << "\n=== MODERN C++ FEATURES ===" << endl;
+    
+    // Move semantics
+    cout << "--- Move Semantics ---" << endl;
+    MovableClass obj1(3);
+    MovableClass obj2 = move(obj1);  // Move constructor
+    MovableClass obj3 = createMovableObject();  // Move or RVO
+    
+    // Small sizes fit inside the object: no allocation at all
+    SmallMovableClass<8> small(5);
+    SmallMovableClass<8> large(20);
+    SmallMovableClass<8> moved = move(small);
+    int smallSum = 0;
+    for (int v : moved.getData()) smallSum += v;
+    cout << "Inline: " << boolalpha << moved.usesInlineStorage()
+         << ", heap: " << !large.usesInlineStorage() << ", sum " << smallSum << endl;
+    
+    // Auto and decltype
+    cout << "\n--- Auto and Decltype ---" << endl;
+    auto x = 42;        // int
+    auto y = 3.14;      // double
+    auto z = "hello";   // const char*
+    
+    vector<int> vec = {1, 2, 3};
+    auto it = vec.begin();  // vector<int>::iterator
+    
+    decltype(x) another_x = 100;  // int
+    cout << "Auto variables: " << x << ", " << y << endl;
+    
+    // Range-based for loops (C++11)
+    cout << "\n--- Range-based For ---" << endl;
+    for (const auto& element : vec) {
+        cout << element << " ";
+    }
+    cout << endl;
+    
+    // Uniform initialization (C++11)
+    cout << "\n--- Uniform Initialization ---" << endl;
+    int a{42};
+    vector<int> numbers{1, 2, 3, 4, 5};
+    map<string, int> ages{{"Alice", 30}, {"Bob", 25}};
+    
+    // Initializer lists
+    auto initList = {1, 2, 3, 4, 5};
+    for (auto val : initList) {
+        cout << val << " ";
+    }
+    cout << endl;
+    
+    // nullptr (C++11)
+    cout << "\n--- Nullptr ---" << endl;
+    int* ptr = nullptr;  // Better than NULL
+    if (ptr == nullptr) {
+        cout << "Pointer is null" << endl;
+    }
+    
+    // Strongly typed enums (C++11)
+    enum class Color { RED, GREEN, BLUE };
+    enum class Size { SMALL, MEDIUM, LARGE };
+    
+    Color c = Color::RED;
+    // Size s = Size::RED;  // Error: different enum types
+    
+    // constexpr (C++11)
+    constexpr int fact5 = factorial(5);  // Computed at compile time
+    cout << "5! = " << fact5 << endl;
+}
+
+/*
+===============================================================================
+                            15. ADVANCED TOPICS
+===============================================================================
+*/
+
+// 15.1 Function Objects and Functors
+class Multiplier {
+private:
+    int factor;
+    
+public:
+    Multiplier(int f) : factor(f) {}
+    
+    int operator()(int x) const {
+        return x * factor;
+    }
+};
+
+// 15.2 Template Metaprogramming
+template<int N>
+struct Factorial {
+    static const int value = N * Factorial<N-1>::value;
+};
+
+template<>
+struct Factorial<0> {
+    static const int value = 1;
+};
+
+// 15.3 SFINAE (Substitution Failure Is Not An Error)
+template<typename T>
+typename enable_if<is_integral<T>::value, T>::type
+safeAdd(T a, T b) {
+    return a + b;
+}
+
+template<typename T>
+typename enable_if<is_floating_point<T>::value, T>::type
+safeAdd(T a, T b) {
+    return a + b + 0.001;  // Add small epsilon for floating point
+}
+
+// 15.4 Variadic Templates (C++11)
+template<typename T>
+void print(const T& value) {
+    cout << value << endl;
+}
+
+template<typename T, typename... Args>
+void print(const T& first, const Args&... args) {
+    cout << first << " ";
+    print(args...);  // Recursive call
+}
+
+// 15.5 Buffered Output
+// Same shape as print(), but values are formatted with to_chars into a fixed
+// per-thread buffer that is written out only when it is nearly full or on
+// flushOutput(). No locale, no allocation, no flush per line. When the
+// buffer fills mid-line only the complete lines go out and the partial one
+// stays behind, so threads never interleave within a line unless a single
+// line is longer than the 64 KB buffer. Call flushOutput() before switching
+// back to cout so output stays in order.
+class OutputSink {
+private:
+    static constexpr size_t CAPACITY = 64 * 1024;
+    static constexpr size_t FLUSH_THRESHOLD = CAPACITY - 1024;
+    
+    char buffer[CAPACITY];
+    size_t used = 0;
+    FILE* target;
+    
+    void reserve(size_t bytes) {
+        if (bytes <= CAPACITY - used) return;
+        flushCompleteLines();
+        if (bytes > CAPACITY - used) flush();  // One line longer than the buffer
+    }
+    
+    // Writes up to the last '\n' and moves the unfinished line to the front
+    void flushCompleteLines() {
+        size_t lastNewline = string_view(buffer, used).rfind('\n');
+        if (lastNewline == string_view::npos) return;
+        size_t complete = lastNewline + 1;
+        fwrite(buffer, 1, complete, target);
+        fflush(target);
+        memmove(buffer, buffer + complete, used - complete);
+        used -= complete;
+    }
+    
+public:
+    explicit OutputSink(FILE* out) : target(out) {}
+    ~OutputSink() { flush(); }
+    
+    OutputSink(const OutputSink&) = delete;
+    OutputSink& operator=(const OutputSink&) = delete;
+    
+    static OutputSink& local() {
+        thread_local OutputSink sink(stdout);
+        return sink;
+    }
+    
+    void append(string_view text) {
+        reserve(text.size());
+        if (text.size() > CAPACITY) {
+            fwrite(text.data(), 1, text.size(), target);
+            return;
+        }
+        memcpy(buffer + used, text.data(), text.size());
+        used += text.size();
+    }
+    
+    void append(const char* text) { append(string_view(text)); }
+    void append(const string& text) { append(string_view(text)); }
+    
+    void append(char c) {
+        reserve(1);
+        buffer[used++] = c;
+    }
+    
+    void append(bool value) { append(value ? string_view("true") : string_view("false")); }
+    
+    template<typename T>
+    void append(T value) {
+        static_assert(is_arithmetic<T>::value, "OutputSink can only format numbers and text");
+        reserve(32);
+        auto result = to_chars(buffer + used, buffer + CAPACITY, value);
+        used = result.ptr - buffer;
+    }
+    
+    void endLine() {
+        append('\n');
+        if (used >= FLUSH_THRESHOLD) flush();
+    }
+    
+    void flush() {
+        if (used > 0) {
+            fwrite(buffer, 1, used, target);
+            fflush(target);
+            used = 0;
+        }
+    }
+};
+
+template<typename T>
+void fastPrint(const T& value) {
+    OutputSink& sink = OutputSink::local();
+    sink.append(value);
+    sink.endLine();
+}
+
+template<typename T, typename... Args>
+void fastPrint(const T& first, const Args&... args) {
+    OutputSink& sink = OutputSink::local();
+    sink.append(first);
+    sink.append(' ');
+    fastPrint(args...);  // Recursive call, like print()
+}
+
+void flushOutput() {
+    OutputSink::local().flush();
+}
+
+// 15.6 Type Traits
+template<typename T>
+void analyzeType(const T& value) {
+    cout << "\nType analysis:" << endl;
+    cout << "Is integral: " << boolalpha << is_integral<T>::value << endl;
+    cout << "Is floating point: " << is_floating_point<T>::value << endl;
+    cout << "Is pointer: " << is_pointer<T>::value << endl;
+    cout << "Is reference: " << is_reference<T>::value << endl;
+    cout << "Size: " << sizeof(T) << " bytes" << endl;
+}
+
+void advancedTopics() {
+    cout << "\n=== ADVANCED TOPICS ===" << endl;
+    
+    // Function objects
+    cout << "--- Function Objects ---" << endl;
+    Multiplier times3(3);
+    cout << "5 * 3 = " << times3(5) << endl;
+    
+    vector<int> nums = {1, 2, 3, 4, 5};
+    transform(nums.begin(), nums.end(), nums.begin(), times3);
+    cout << "After multiplication by 3: ";
+    for (auto n : nums) cout << n << " ";
+    cout << endl;
+    
+    // Template metaprogramming
+    cout << "\n--- Template Metaprogramming ---" << endl;
+    cout << "Factorial<5>::value = " << Factorial<5>::value << endl;
+    
+    // SFINAE
+    cout << "\n--- SFINAE ---" << endl;
+    cout << "safeAdd(5, 3) = " << safeAdd(5, 3) << endl;
+    cout << "safeAdd(5.5, 3.2) = " << safeAdd(5.5, 3.2) << endl;
+    
+    // Variadic templates
+    cout << "\n--- Variadic Templates ---" << endl;
+    print("Hello", 42, 3.14, "World", true);
+    fastPrint("Hello", 42, 3.14, "World", true);
+    flushOutput();
+    
+    // Type traits
+    analyzeType(42);
+    analyzeType(3.14);
+    int* ptr = nullptr;
+    analyzeType(ptr);
+}
+
+/*
+===============================================================================
+                            16. DESIGN PATTERNS
+===============================================================================
+*/
+
+// 16.1 Singleton Pattern
+// A function-local static is initialized exactly once even when the first
+// calls race (C++11 "magic statics"); afterwards each call is one
+// already-initialized check. Derived classes keep their constructor private
+// and befriend the base. THREAD scope gives every thread its own instance,
+// for hot state that is never shared.
+enum class InstanceScope { PROCESS, THREAD };
+
+template<typename Derived, InstanceScope Scope = InstanceScope::PROCESS>
+class SingletonBase {
+public:
+    static Derived& instance() {
+        if constexpr (Scope == InstanceScope::THREAD) {
+            thread_local Derived perThread;
+            return perThread;
+        } else {
+            static Derived shared;
+            return shared;
+        }
+    }
+    
+    static Derived* getInstance() {
+        return &instance();
+    }
+    
+    SingletonBase(const SingletonBase&) = delete;
+    SingletonBase& operator=(const SingletonBase&) = delete;
+    
+protected:
+    SingletonBase() = default;
+    ~SingletonBase() = default;
+};
+
+class Singleton : public SingletonBase<Singleton> {
+private:
+    friend class SingletonBase<Singleton>;
+    Singleton() = default;  // Private constructor
+    
+public:
+    void doSomething() {
+        cout << "Singleton is doing something..." << endl;
+    }
+};
+
+// One per thread: counts work without sharing a cache line
+class ThreadScratch : public SingletonBase<ThreadScratch, InstanceScope::THREAD> {
+private:
+    friend class SingletonBase<ThreadScratch, InstanceScope::THREAD>;
+    ThreadScratch() = default;
+    
+public:
+    vector<int> buffer;
+    size_t uses = 0;
+};
+
+// 16.2 Observer Pattern
+class Observer {
+public:
+    virtual ~Observer() = default;
+    virtual void update(int value) = 0;
+};
+
+class Subject {
+private:
+    vector<Observer*> observers;
+    int state;
+    
+public:
+    void addObserver(Observer* obs) {
+        observers.push_back(obs);
+    }
+    
+    void removeObserver(Observer* obs) {
+        observers.erase(remove(observers.begin(), observers.end(), obs), observers.end());
+    }
+    
+    void setState(int newState) {
+        state = newState;
+        notifyObservers();
+    }
+    
+    int getState() const { return state; }
+    
+private:
+    void notifyObservers() {
+        for (auto* obs : observers) {
+            obs->update(state);
+        }
+    }
+};
+
+class ConcreteObserver : public Observer {
+private:
+    string name;
+    
+public:
+    ConcreteObserver(const string& n) : name(n) {}
+    
+    void update(int value) override {
+        cout << "Observer " << name << " received update: " << value << endl;
+    }
+};
+
+// Concurrent Subject
+// Subject's vector is read by notifyObservers() while add/removeObserver
+// change it, so it needs a lock once several threads are involved.
+// ConcurrentSubject never changes a published list: writers copy it, edit
+// the copy and swap the pointer (copy-on-write, like RCU). Notifying only
+// has to protect the current list with a hazard pointer, so setState()
+// takes no lock even while subscriptions change. Replaced lists are kept
+// until no reader holds them; removeObserver() waits for all of them, since
+// any older list may still contain the observer being removed.
+class ConcurrentSubject {
+private:
+    using ObserverList = vector<Observer*>;
+    
+    atomic<const ObserverList*> observers;
+    mutex writeMutex;                  // Serializes writers only
+    vector<const ObserverList*> stale; // Replaced lists readers may still hold
+    atomic<int> state{0};
+    atomic<ThreadPool*> asyncPool{nullptr};  // Set: deliver on the pool
+    atomic<size_t> inFlight{0};        // Async deliveries not yet finished
+    
+    // Caller holds writeMutex
+    template<typename Edit>
+    void replaceList(Edit edit) {
+        const ObserverList* current = observers.load();
+        auto* next = new ObserverList(*current);
+        edit(*next);
+        observers.store(next);
+        stale.push_back(current);
+    }
+    
+    // Caller holds writeMutex. Frees the replaced lists no reader holds;
+    // with waitForAll, waits for the rest and frees them too.
+    void reclaimStale(bool waitForAll) {
+        HazardPointers& hazards = HazardPointers::instance();
+        size_t kept = 0;
+        for (const ObserverList* list : stale) {
+            while (waitForAll && hazards.isProtected(list)) {
+                this_thread::yield();
+            }
+            if (hazards.isProtected(list)) stale[kept++] = list;
+            else delete list;
+        }
+        stale.resize(kept);
+    }
+    
+    void deliver(const int* values, size_t count) {
+        HazardPointers::Guard guard;
+        const ObserverList* list = guard.protect(observers);
+        // Observer-major order keeps each observer hot for the whole batch
+        for (Observer* obs : *list) {
+            for (size_t i = 0; i < count; i++) {
+                obs->update(values[i]);
+            }
+        }
+    }
+    
+    void dispatch(vector<int> values) {
+        ThreadPool* pool = asyncPool.load(memory_order_acquire);
+        if (pool == nullptr) {
+            deliver(values.data(), values.size());
+            return;
+        }
+        inFlight.fetch_add(1);
+        pool->submit([this, values = move(values)]() {
+            deliver(values.data(), values.size());
+            inFlight.fetch_sub(1, memory_order_release);
+        });
+    }
+    
+public:
+    ConcurrentSubject() : observers(new ObserverList()) {}
+    
+    ~ConcurrentSubject() {
+        waitForDelivery();
+        for (const ObserverList* list : stale) delete list;
+        delete observers.load();
+    }
+    
+    ConcurrentSubject(const ConcurrentSubject&) = delete;
+    ConcurrentSubject& operator=(const ConcurrentSubject&) = delete;
+    
+    void addObserver(Observer* obs) {
+        addObservers({obs});
+    }
+    
+    // One copy of the list for the whole batch of subscriptions
+    void addObservers(const vector<Observer*>& added) {
+        lock_guard<mutex> lock(writeMutex);
+        replaceList([&](ObserverList& list) {
+            list.insert(list.end(), added.begin(), added.end());
+        });
+        reclaimStale(false);
+    }
+    
+    // Returns once no notification can still reach obs, so it may be
+    // destroyed right after: every list but the new one is waited for, and
+    // the lock keeps a concurrent writer from publishing a list with obs.
+    // Must not be called from inside update().
+    void removeObserver(Observer* obs) {
+        lock_guard<mutex> lock(writeMutex);
+        replaceList([obs](ObserverList& list) {
+            auto it = find(list.begin(), list.end(), obs);
+            if (it != list.end()) {
+                *it = list.back();  // Order is not kept: O(1) erase after the find
+                list.pop_back();
+            }
+        });
+        reclaimStale(true);
+    }
+    
+    // Hand notifications to a pool instead of running them on the caller.
+    // Deliveries of different setState calls may then run out of order.
+    void enableAsyncDelivery(ThreadPool& pool) {
+        asyncPool.store(&pool, memory_order_release);
+    }
+    
+    void waitForDelivery() {
+        while (inFlight.load(memory_order_acquire) > 0) {
+            ThreadPool* pool = asyncPool.load(memory_order_acquire);
+            if (pool == nullptr || !pool->runPendingTask()) this_thread::yield();
+        }
+    }
+    
+    void setState(int newState) {
+        state.store(newState, memory_order_relaxed);
+        dispatch({newState});
+    }
+    
+    // Several state changes in one pass over the observers
+    void setStates(span<const int> newStates) {
+        if (newStates.empty()) return;
+        state.store(newStates.back(), memory_order_relaxed);
+        dispatch(vector<int>(newStates.begin(), newStates.end()));
+    }
+    
+    int getState() const { return state.load(memory_order_relaxed); }
+    
+    size_t observerCount() const {
+        HazardPointers::Guard guard;
+        return guard.protect(observers)->size();
+    }
+};
+
+// Event Bus
+// setState() above still runs every update() on the producer's thread, so
+// one slow observer stalls it. The bus gives each subscriber its own bounded
+// queue and consumer thread; producers only enqueue, and consumers drain up
+// to batchSize events at a time. When a queue is full the policy decides:
+// wait for room, evict the oldest event, or drop the new one.
+enum class Backpressure { BLOCK, DROP_OLDEST, DROP_NEWEST };
+
+// Log-scale latency buckets: four per power of two, lock-free to record
+class LatencyHistogram {
+private:
+    static constexpr size_t BUCKETS = 64 * 4;
+    array<atomic<uint64_t>, BUCKETS> counts{};
+    
+    static size_t bucketFor(uint64_t ns) {
+        if (ns < 4) return ns;
+        unsigned bits = 63 - __builtin_clzll(ns);
+        return bits * 4 + ((ns >> (bits - 2)) & 3);
+    }
+    
+    static uint64_t bucketUpperBound(size_t bucket) {
+        if (bucket < 4) return bucket;
+        unsigned bits = bucket / 4;
+        return (uint64_t(4 + bucket % 4 + 1) << (bits - 2)) - 1;
+    }
+    
+public:
+    void record(uint64_t ns) {
+        counts[bucketFor(ns)].fetch_add(1, memory_order_relaxed);
+    }
+    
+    uint64_t total() const {
+        uint64_t sum = 0;
+        for (auto& c : counts) sum += c.load(memory_order_relaxed);
+        return sum;
+    }
+    
+    // Upper bound of the bucket holding the given percentile (0-100)
+    uint64_t percentile(double p) const {
+        uint64_t target = static_cast<uint64_t>(total() * p / 100.0);
+        uint64_t seen = 0;
+        for (size_t b = 0; b < BUCKETS; b++) {
+            seen += counts[b].load(memory_order_relaxed);
+            if (seen > target) return bucketUpperBound(b);
+        }
+        return 0;
+    }
+    
+    void reset() {
+        for (auto& c : counts) c.store(0, memory_order_relaxed);
+    }
+    
+    // Adds another histogram's counts, e.g. one kept per consumer thread
+    void merge(const LatencyHistogram& other) {
+        for (size_t b = 0; b < BUCKETS; b++) {
+            counts[b].fetch_add(other.counts[b].load(memory_order_relaxed), memory_order_relaxed);
+        }
+    }
+};
+
+class EventBus {
+private:
+    struct Event {
+        int value = 0;
+        long long publishedNs = 0;
+    };
+    
+    struct Subscriber {
+        Observer* observer;
+        BoundedQueue<Event> queue;
+        thread consumer;
+        
+        Subscriber(Observer* obs, size_t capacity) : observer(obs), queue(capacity) {}
+    };
+    
+    vector<unique_ptr<Subscriber>> subscribers;
+    size_t capacity;
+    Backpressure policy;
+    size_t batchSize;
+    atomic<bool> running{false};
+    atomic<uint64_t> droppedEvents{0};
+    LatencyHistogram histogram;
+    
+    static long long nowNs() {
+        return chrono::duration_cast<chrono::nanoseconds>(
+            chrono::steady_clock::now().time_since_epoch()).count();
+    }
+    
+    void consume(Subscriber& sub) {
+        vector<Event> batch(batchSize);
+        unsigned idle = 0;
+        while (true) {
+            size_t n = 0;
+            while (n < batchSize && sub.queue.tryPop(batch[n])) n++;
+            if (n == 0) {
+                if (!running.load(memory_order_acquire) && sub.queue.sizeApprox() == 0) return;
+                // Spin briefly, then back off so an idle bus costs no CPU
+                if (++idle < 64) this_thread::yield();
+                else this_thread::sleep_for(chrono::microseconds(50));
+                continue;
+            }
+            idle = 0;
+            long long dequeued = nowNs();
+            for (size_t i = 0; i < n; i++) {
+                histogram.record(static_cast<uint64_t>(max(0LL, dequeued - batch[i].publishedNs)));
+            }
+            for (size_t i = 0; i < n; i++) {
+                sub.observer->update(batch[i].value);
+            }
+        }
+    }
+    
+    bool enqueue(Subscriber& sub, const Event& event) {
+        switch (policy) {
+            case Backpressure::BLOCK:
+                while (!sub.queue.tryPush(event)) this_thread::yield();
+                return true;
+            case Backpressure::DROP_OLDEST: {
+                Event evicted;
+                while (!sub.queue.tryPush(event)) {
+                    if (sub.queue.tryPop(evicted)) droppedEvents.fetch_add(1, memory_order_relaxed);
+                }
+                return true;
+            }
+            case Backpressure::DROP_NEWEST:
+            default:
+                if (sub.queue.tryPush(event)) return true;
+                droppedEvents.fetch_add(1, memory_order_relaxed);
+                return false;
+        }
+    }
+    
+public:
+    explicit EventBus(size_t capacityPerSubscriber = 4096,
+                      Backpressure backpressure = Backpressure::BLOCK,
+                      size_t batch = 64)
+        : capacity(capacityPerSubscriber), policy(backpressure), batchSize(max<size_t>(1, batch)) {}
+    
+    ~EventBus() { stop(); }
+    
+    EventBus(const EventBus&) = delete;
+    EventBus& operator=(const EventBus&) = delete;
+    
+    // Subscriptions are fixed once the bus is started
+    void subscribe(Observer* obs) {
+        if (running.load()) {
+            throw runtime_error("Cannot subscribe to a running event bus");
+        }
+        subscribers.push_back(make_unique<Subscriber>(obs, capacity));
+    }
+    
+    void start() {
+        if (running.exchange(true)) return;
+        for (auto& sub : subscribers) {
+            sub->consumer = thread(&EventBus::consume, this, ref(*sub));
+        }
+    }
+    
+    // Delivers everything already published, then joins the consumers
+    void stop() {
+        running.store(false, memory_order_release);
+        for (auto& sub : subscribers) {
+            if (sub->consumer.joinable()) sub->consumer.join();
+        }
+    }
+    
+    // Safe from any number of threads; false if some subscriber dropped it
+    bool publish(int value) {
+        Event event{value, nowNs()};
+        bool deliveredToAll = true;
+        for (auto& sub : subscribers) {
+            deliveredToAll &= enqueue(*sub, event);
+        }
+        return deliveredToAll;
+    }
+    
+    uint64_t dropped() const { return droppedEvents.load(memory_order_relaxed); }
+    const LatencyHistogram& latency() const { return histogram; }
+};
+
+// 16.3 Factory Pattern
+class Product {
+public:
+    virtual ~Product() = default;
+    virtual void use() = 0;
+    virtual double price() const = 0;
+};
+
+// final lets calls on the concrete type skip the vtable
+class ConcreteProductA final : public Product {
+public:
+    void use() override {
+        cout << "Using Product A" << endl;
+    }
+    
+    double price() const override { return 10.0; }
+};
+
+class ConcreteProductB final : public Product {
+public:
+    void use() override {
+        cout << "Using Product B" << endl;
+    }
+    
+    double price() const override { return 25.0; }
+};
+
+class Factory {
+public:
+    enum ProductType { TYPE_A, TYPE_B };
+    
+    static unique_ptr<Product> createProduct(ProductType type) {
+        switch (type) {
+            case TYPE_A:
+                return make_unique<ConcreteProductA>();
+            case TYPE_B:
+                return make_unique<ConcreteProductB>();
+            default:
+                return nullptr;
+        }
+    }
+};
+
+// Static Factory
+// When the set of products is closed, a variant holds whichever one was made
+// in place: no heap allocation, and visit() calls the concrete member
+// directly instead of going through the vtable.
+using ProductVariant = variant<ConcreteProductA, ConcreteProductB>;
+
+class StaticFactory {
+public:
+    static ProductVariant createProduct(Factory::ProductType type) {
+        switch (type) {
+            case Factory::TYPE_B:
+                return ConcreteProductB();
+            case Factory::TYPE_A:
+            default:
+                return ConcreteProductA();
+        }
+    }
+    
+    static void use(ProductVariant& product) {
+        visit([](auto& p) { p.use(); }, product);
+    }
+    
+    static double price(const ProductVariant& product) {
+        return visit([](const auto& p) { return p.price(); }, product);
+    }
+};
+
+// Pooled Factory
+// Keeps products polymorphic but recycles fixed-size blocks from a free list
+// instead of calling new/delete per product. One pool per thread; products
+// must be destroyed before their factory.
+class PooledFactory {
+private:
+    static constexpr size_t BLOCK_SIZE = max(sizeof(ConcreteProductA), sizeof(ConcreteProductB));
+    static constexpr size_t BLOCK_ALIGN = max(alignof(ConcreteProductA), alignof(ConcreteProductB));
+    static constexpr size_t BLOCKS_PER_CHUNK = 256;
+    
+    union Block {
+        Block* next;
+        alignas(BLOCK_ALIGN) unsigned char storage[BLOCK_SIZE];
+    };
+    
+    vector<unique_ptr<Block[]>> chunks;
+    Block* freeList = nullptr;
+    
+    void* allocate() {
+        if (freeList == nullptr) {
+            chunks.push_back(make_unique<Block[]>(BLOCKS_PER_CHUNK));
+            Block* chunk = chunks.back().get();
+            for (size_t i = 0; i < BLOCKS_PER_CHUNK; i++) {
+                chunk[i].next = freeList;
+                freeList = &chunk[i];
+            }
+        }
+        Block* block = freeList;
+        freeList = block->next;
+        return block;
+    }
+    
+    void release(void* p) {
+        Block* block = static_cast<Block*>(p);
+        block->next = freeList;
+        freeList = block;
+    }
+    
+public:
+    // Destroys the product and hands its block back to the pool. The block
+    // holds the whole object, which need not start at its Product part, so
+    // dynamic_cast<void*> recovers the block address first.
+    struct Deleter {
+        PooledFactory* pool;
+        void operator()(Product* p) const {
+            void* block = dynamic_cast<void*>(p);
+            p->~Product();
+            pool->release(block);
+        }
+    };
+    
+    using Pointer = unique_ptr<Product, Deleter>;
+    
+    PooledFactory() = default;
+    PooledFactory(const PooledFactory&) = delete;
+    PooledFactory& operator=(const PooledFactory&) = delete;
+    
+    template<typename T>
+    Pointer create() {
+        static_assert(is_base_of_v<Product, T>, "PooledFactory only makes Products");
+        static_assert(sizeof(T) <= BLOCK_SIZE && alignof(T) <= BLOCK_ALIGN,
+                      "Product does not fit the pool's blocks");
+        void* memory = allocate();
+        return Pointer(new (memory) T(), Deleter{this});
+    }
+    
+    Pointer createProduct(Factory::ProductType type) {
+        switch (type) {
+            case Factory::TYPE_B:
+                return create<ConcreteProductB>();
+            case Factory::TYPE_A:
+            default:
+                return create<ConcreteProductA>();
+        }
+    }
+};
+
+void designPatterns() {
+    cout << "\n=== DESIGN PATTERNS ===" << endl;
+    
+    // Singleton
+    cout << "--- Singleton Pattern ---" << endl;
+    Singleton* s1 = Singleton::getInstance();
+    Singleton* s2 = Singleton::getInstance();
+    cout << "Same instance: " << boolalpha << (s1 == s2) << endl;
+    s1->doSomething();
+    
+    ThreadScratch* mainScratch = ThreadScratch::getInstance();
+    bool differs = false;
+    thread([&]() { differs = ThreadScratch::getInstance() != mainScratch; }).join();
+    cout << "Per-thread instances differ: " << differs << endl;
+    
+    // Observer
+    cout << "\n--- Observer Pattern ---" << endl;
+    Subject subject;
+    ConcreteObserver obs1("Observer1");
+    ConcreteObserver obs2("Observer2");
+    
+    subject.addObserver(&obs1);
+    subject.addObserver(&obs2);
+    
+    subject.setState(42);
+    subject.setState(100);
+    
+    // Same pattern, safe to notify and (un)subscribe from several threads
+    ConcurrentSubject sharedSubject;
+    sharedSubject.addObservers({&obs1, &obs2});
+    array<int, 2> batch = {7, 8};
+    sharedSubject.setStates(batch);
+    sharedSubject.removeObserver(&obs1);
+    sharedSubject.setState(9);
+    
+    // Event bus: observers are updated on their own consumer threads
+    {
+        EventBus bus(16, Backpressure::BLOCK);
+        ConcreteObserver busObserver("BusObserver");
+        bus.subscribe(&busObserver);
+        bus.start();
+        bus.publish(1);
+        bus.publish(2);
+        bus.stop();  // Drains, so both updates are printed before we go on
+    }
+    
+    // Factory
+    cout << "\n--- Factory Pattern ---" << endl;
+    auto productA = Factory::createProduct(Factory::TYPE_A);
+    auto productB = Factory::createProduct(Factory::TYPE_B);
+    
+    productA->use();
+    productB->use();
+    
+    // Same products without heap allocation or virtual calls
+    ProductVariant inPlace = StaticFactory::createProduct(Factory::TYPE_B);
+    StaticFactory::use(inPlace);
+    cout << "Variant product price: " << StaticFactory::price(inPlace) << endl;
+    
+    PooledFactory pooled;
+    auto pooledProduct = pooled.createProduct(Factory::TYPE_A);
+    pooledProduct->use();
+}
+
+/*
+===============================================================================
+                        17. PERFORMANCE BENCHMARKS
+===============================================================================
+*/
+
+// Run with: ./cpp_guide --bench [name] [--max-n=N] [--threads=T]
+struct BenchConfig {
+    size_t maxN = 10000000;
+    unsigned maxThreads = max(1u, thread::hardware_concurrency());
+    string filter;
+};
+
+BenchConfig benchConfig;
+
+// Keeps the optimizer from deleting work whose result is never used
+template<typename T>
+void doNotOptimize(const T& value) {
+#if defined(__GNUC__) || defined(__clang__)
+    asm volatile("" : : "r,m"(value) : "memory");
+#else
+    static volatile const void* sink;
+    sink = &value;
+#endif
+}
+
+template<typename F>
+double timeSeconds(F&& body) {
+    auto start = chrono::steady_clock::now();
+    body();
+    auto end = chrono::steady_clock::now();
+    return chrono::duration<double>(end - start).count();
+}
+
+// Starts `threads` threads running body(threadId) and times until all join
+template<typename F>
+double timeThreads(unsigned threads, F&& body) {
+    vector<thread> pool;
+    pool.reserve(threads);
+    auto start = chrono::steady_clock::now();
+    for (unsigned t = 0; t < threads; t++) {
+        pool.emplace_back([&body, t]() { body(t); });
+    }
+    for (auto& th : pool) {
+        th.join();
+    }
+    auto end = chrono::steady_clock::now();
+    return chrono::duration<double>(end - start).count();
+}
+
+// Repeats body until at least minSeconds have passed; returns seconds per call
+template<typename F>
+double timePerCall(F&& body, double minSeconds = 0.1) {
+    size_t calls = 0;
+    double elapsed = 0;
+    auto start = chrono::steady_clock::now();
+    do {
+        body();
+        calls++;
+        elapsed = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    } while (elapsed < minSeconds);
+    return elapsed / calls;
+}
+
+#if GUIDE_POSIX
+// Points stdout at /dev/null while timing body, then puts it back
+template<typename F>
+double timeSilenced(F&& body) {
+    cout.flush();
+    fflush(stdout);
+    int saved = dup(STDOUT_FILENO);
+    int devNull = ::open("/dev/null", O_WRONLY);
+    dup2(devNull, STDOUT_FILENO);
+    ::close(devNull);
+    double t = timeSeconds(forward<F>(body));
+    cout.flush();
+    fflush(stdout);
+    dup2(saved, STDOUT_FILENO);
+    ::close(saved);
+    return t;
+}
+#endif
+
+// 1, 2, 4, ... up to and including maxThreads
+vector<unsigned> threadSweep() {
+    vector<unsigned> counts;
+    for (unsigned t = 1; t < benchConfig.maxThreads; t *= 2) {
+        counts.push_back(t);
+    }
+    counts.push_back(benchConfig.maxThreads);
+    return counts;
+}
+
+// 10^3, 10^4, ... up to maxN
+vector<size_t> sizeSweep(size_t from = 1000) {
+    vector<size_t> sizes;
+    for (size_t n = from; n <= benchConfig.maxN; n *= 10) {
+        sizes.push_back(n);
+    }
+    return sizes;
+}
+
+string humanRate(double perSecond) {
+    const char* suffixes[] = {"", "K", "M", "G", "T"};
+    int i = 0;
+    while (perSecond >= 1000.0 && i < 4) {
+        perSecond /= 1000.0;
+        i++;
+    }
+    stringstream ss;
+    ss << fixed << setprecision(perSecond < 10 ? 2 : 1) << perSecond << suffixes[i];
+    return ss.str();
+}
+
+void benchCounters() {
+    cout << "\n--- Counter increments (ops/sec) ---" << endl;
+    cout << setw(8) << "threads" << setw(14) << "increments"
+         << setw(12) << "mutex" << setw(12) << "atomic" << setw(12) << "sharded" << endl;
+    
+    for (unsigned threads : threadSweep()) {
+        for (size_t n : sizeSweep()) {
+            size_t perThread = n / threads;
+            size_t total = perThread * threads;
+            
+            mutex benchMutex;
+            long long plain = 0;
+            double mutexTime = timeThreads(threads, [&](unsigned) {
+                for (size_t i = 0; i < perThread; i++) {
+                    lock_guard<mutex> lock(benchMutex);
+                    plain++;
+                }
+            });
+            
+            atomic<long long> shared{0};
+            double atomicTime = timeThreads(threads, [&](unsigned) {
+                for (size_t i = 0; i < perThread; i++) {
+                    shared.fetch_add(1, memory_order_relaxed);
+                }
+            });
+            
+            ShardedCounter sharded(threads);
+            double shardedTime = timeThreads(threads, [&](unsigned) {
+                for (size_t i = 0; i < perThread; i++) {
+                    sharded.increment();
+                }
+            });
+            
+            if (plain != (long long)total || shared != (long long)total ||
+                sharded.load() != (long long)total) {
+                cout << "Counter mismatch at " << threads << " threads!" << endl;
+            }
+            
+            cout << setw(8) << threads << setw(14) << total
+                 << setw(12) << humanRate(total / mutexTime)
+                 << setw(12) << humanRate(total / atomicTime)
+                 << setw(12) << humanRate(total / shardedTime) << endl;
+        }
+    }
+}
+
+void benchThreadPool() {
+    cout << "\n--- Task launch: pool vs thread-per-task vs std::async ---" << endl;
+    cout << setw(10) << "tasks" << setw(14) << "pool ns/rt" << setw(14) << "thread ns/rt"
+         << setw(14) << "async ns/rt" << setw(14) << "pool /s" << setw(14) << "thread /s"
+         << setw(14) << "async /s" << endl;
+    
+    ThreadPool pool(benchConfig.maxThreads);
+    atomic<long long> sink{0};
+    auto task = [&sink]() { sink.fetch_add(1, memory_order_relaxed); };
+    const size_t wave = 256;  // Outstanding OS threads at once for the batch runs
+    
+    for (size_t n : sizeSweep()) {
+        if (n > 1000000) break;  // Thread-per-task gets impractical beyond this
+        
+        // Round trip: launch one task and wait for it, n times
+        double poolRt = timeSeconds([&]() {
+            for (size_t i = 0; i < n; i++) pool.submit(task).get();
+        });
+        double threadRt = timeSeconds([&]() {
+            for (size_t i = 0; i < n; i++) thread(task).join();
+        });
+        double asyncRt = timeSeconds([&]() {
+            for (size_t i = 0; i < n; i++) async(launch::async, task).get();
+        });
+        
+        // Throughput: keep many tasks in flight
+        double poolBatch = timeSeconds([&]() {
+            pool.parallelFor(0, n, [&](size_t) { task(); }, 1);
+        });
+        double threadBatch = timeSeconds([&]() {
+            vector<thread> threads;
+            for (size_t i = 0; i < n; i += wave) {
+                for (size_t j = i; j < min(n, i + wave); j++) threads.emplace_back(task);
+                for (auto& th : threads) th.join();
+                threads.clear();
+            }
+        });
+        double asyncBatch = timeSeconds([&]() {
+            vector<future<void>> futures;
+            for (size_t i = 0; i < n; i += wave) {
+                for (size_t j = i; j < min(n, i + wave); j++) {
+                    futures.push_back(async(launch::async, task));
+                }
+                for (auto& f : futures) f.get();
+                futures.clear();
+            }
+        });
+        
+        cout << setw(10) << n
+             << setw(14) << (long long)(poolRt * 1e9 / n)
+             << setw(14) << (long long)(threadRt * 1e9 / n)
+             << setw(14) << (long long)(asyncRt * 1e9 / n)
+             << setw(14) << humanRate(n / poolBatch)
+             << setw(14) << humanRate(n / threadBatch)
+             << setw(14) << humanRate(n / asyncBatch) << endl;
+    }
+    doNotOptimize(sink.load());
+}
+
+void benchShapeStore() {
+    cout << "\n--- Shape areas: virtual dispatch vs ShapeStore (shapes/sec) ---" << endl;
+    cout << setw(12) << "shapes" << setw(14) << "virtual" << setw(14) << "soa total"
+         << setw(14) << "soa areas" << endl;
+    
+    for (size_t n : sizeSweep()) {
+        vector<unique_ptr<Shape>> shapes;
+        ShapeStore store;
+        shapes.reserve(n);
+        store.reserve(n, 0);
+        for (size_t i = 0; i < n; i++) {
+            double radius = 1.0 + (i % 100) * 0.01;
+            shapes.push_back(make_unique<Circle>(radius));
+            store.addCircle(radius);
+        }
+        vector<double> out(n);
+        
+        double virtualTime = timePerCall([&]() {
+            double total = 0;
+            for (const auto& shape : shapes) total += shape->area();
+            doNotOptimize(total);
+        });
+        double totalTime = timePerCall([&]() {
+            doNotOptimize(store.totalArea());
+        });
+        double areasTime = timePerCall([&]() {
+            store.areas(out.data());
+            doNotOptimize(out[n - 1]);
+        });
+        
+        cout << setw(12) << n
+             << setw(14) << humanRate(n / virtualTime)
+             << setw(14) << humanRate(n / totalTime)
+             << setw(14) << humanRate(n / areasTime) << endl;
+    }
+}
+
+void benchSimdKernels() {
+    cout << "\n--- Integer kernels: std vs SIMD (GB/s) ---" << endl;
+    vector<const IntKernels*> levels = {&intKernels(SimdLevel::SCALAR)};
+    SimdLevel best = detectSimdLevel();
+    if (best >= SimdLevel::SSE2) levels.push_back(&intKernels(SimdLevel::SSE2));
+    if (best >= SimdLevel::AVX2) levels.push_back(&intKernels(SimdLevel::AVX2));
+    
+    cout << setw(12) << "ints" << setw(10) << "kernel" << setw(10) << "std";
+    for (auto* k : levels) cout << setw(10) << k->name;
+    cout << endl;
+    
+    auto gbps = [](size_t bytes, double seconds) {
+        stringstream ss;
+        ss << fixed << setprecision(2) << bytes / seconds / 1e9;
+        return ss.str();
+    };
+    
+    // Sizes from a few KB (L1) up to maxN ints (DRAM)
+    for (size_t n : sizeSweep()) {
+        vector<int> input(n), output(n);
+        for (size_t i = 0; i < n; i++) input[i] = static_cast<int>((i * 2654435761u) % 1000) - 500;
+        size_t bytes = n * sizeof(int);
+        
+        auto row = [&](const char* kernel, size_t moved, auto stdBody, auto simdBody) {
+            cout << setw(12) << n << setw(10) << kernel
+                 << setw(10) << gbps(moved, timePerCall(stdBody));
+            for (auto* k : levels) {
+                cout << setw(10) << gbps(moved, timePerCall([&]() { simdBody(*k); }));
+            }
+            cout << endl;
+        };
+        
+        row("count", bytes,
+            [&]() { doNotOptimize(count(input.begin(), input.end(), 7)); },
+            [&](const IntKernels& k) { doNotOptimize(k.countEqual(input.data(), n, 7)); });
+        row("square", 2 * bytes,
+            [&]() {
+                transform(input.begin(), input.end(), output.begin(), [](int x) {
+                    return static_cast<int>(static_cast<unsigned int>(x) * static_cast<unsigned int>(x));
+                });
+                doNotOptimize(output[0]);
+            },
+            [&](const IntKernels& k) { k.square(input.data(), output.data(), n); doNotOptimize(output[0]); });
+        row("sum", bytes,
+            [&]() { doNotOptimize(accumulate(input.begin(), input.end(), 0LL)); },
+            [&](const IntKernels& k) { doNotOptimize(k.sum(input.data(), n)); });
+        row("minmax", bytes,
+            [&]() { doNotOptimize(*minmax_element(input.begin(), input.end()).first); },
+            [&](const IntKernels& k) { doNotOptimize(k.minMax(input.data(), n).first); });
+    }
+}
+
+void benchSortSearch() {
+    cout << "\n--- Sorting uint32 keys (keys/sec) ---" << endl;
+    cout << setw(12) << "keys" << setw(12) << "std::sort"
+#ifdef GUIDE_PARALLEL_STL
+         << setw(12) << "sort(par)"
+#endif
+         << setw(12) << "radix" << setw(12) << "merge" << endl;
+    
+    ThreadPool pool(benchConfig.maxThreads);
+    mt19937 rng(42);
+    for (size_t n : sizeSweep()) {
+        vector<uint32_t> input(n);
+        for (auto& key : input) key = rng();
+        vector<uint32_t> expected = input;
+        sort(expected.begin(), expected.end());
+        
+        // Each run sorts a fresh copy; the copy itself is timed separately and removed
+        vector<uint32_t> work;
+        double copyTime = timePerCall([&]() { work = input; doNotOptimize(work[0]); });
+        auto rate = [&](auto sorter) {
+            double t = timePerCall([&]() { work = input; sorter(work); }) - copyTime;
+            if (work != expected) cout << "Sort mismatch!" << endl;
+            return humanRate(n / max(t, 1e-9));
+        };
+        
+        cout << setw(12) << n
+             << setw(12) << rate([](vector<uint32_t>& v) { sort(v.begin(), v.end()); })
+#ifdef GUIDE_PARALLEL_STL
+             << setw(12) << rate([](vector<uint32_t>& v) { sort(execution::par, v.begin(), v.end()); })
+#endif
+             << setw(12) << rate([&](vector<uint32_t>& v) { parallelRadixSort(v, pool); })
+             << setw(12) << rate([&](vector<uint32_t>& v) { parallelMergeSort(v, less<uint32_t>(), pool); })
+             << endl;
+    }
+    
+    cout << "\n--- Sorted lookups (queries/sec) ---" << endl;
+    cout << setw(12) << "keys" << setw(16) << "binary_search" << setw(12) << "eytzinger" << endl;
+    for (size_t n : sizeSweep()) {
+        vector<uint32_t> sorted(n);
+        for (auto& key : sorted) key = rng();
+        sort(sorted.begin(), sorted.end());
+        EytzingerIndex<uint32_t> index(sorted);
+        
+        vector<uint32_t> queries(1 << 16);
+        for (size_t i = 0; i < queries.size(); i++) {
+            queries[i] = (i % 2) ? sorted[rng() % n] : static_cast<uint32_t>(rng());
+        }
+        
+        size_t hitsStd = 0, hitsIndex = 0;
+        double stdTime = timePerCall([&]() {
+            hitsStd = 0;
+            for (uint32_t q : queries) hitsStd += binary_search(sorted.begin(), sorted.end(), q);
+        });
+        double indexTime = timePerCall([&]() {
+            hitsIndex = 0;
+            for (uint32_t q : queries) hitsIndex += index.contains(q);
+        });
+        if (hitsStd != hitsIndex) cout << "Search mismatch!" << endl;
+        
+        cout << setw(12) << n << setw(16) << humanRate(queries.size() / stdTime)
+             << setw(12) << humanRate(queries.size() / indexTime) << endl;
+    }
+}
+
+// Fills a stack to `depth` and drains it; returns push+pop pairs per second
+template<typename S, typename T, typename MakeStack, typename PopOne>
+double stackRoundTrips(size_t depth, const T& value, MakeStack makeStack, PopOne popOne) {
+    double t = timePerCall([&]() {
+        S s = makeStack();
+        for (size_t i = 0; i < depth; i++) s.push(T(value));
+        while (!s.empty()) doNotOptimize(popOne(s));
+    });
+    return depth / t;
+}
+
+template<typename T>
+void benchStacksFor(const char* typeName, const T& value) {
+    cout << "\n--- Stack<" << typeName << "> push+pop (pairs/sec) ---" << endl;
+    cout << setw(10) << "depth" << setw(12) << "copy-top" << setw(12) << "move-pop"
+         << setw(12) << "arena" << setw(12) << "pool" << setw(12) << "small<64>" << endl;
+    
+    vector<byte> arenaBuffer;
+    pmr::unsynchronized_pool_resource poolResource;
+    for (size_t depth : {16, 64, 1024, 65536}) {
+        arenaBuffer.resize(depth * sizeof(T) * 4);
+        
+        // The original API: top() copied the element, then pop() discarded it
+        double copyTop = stackRoundTrips<Stack<T>>(depth, value,
+            []() { return Stack<T>(); },
+            [](Stack<T>& s) { T v = static_cast<const Stack<T>&>(s).top(); s.pop(); return v; });
+        double movePop = stackRoundTrips<Stack<T>>(depth, value,
+            []() { return Stack<T>(); },
+            [](Stack<T>& s) { return s.pop(); });
+        
+        double arena = 0, pool = 0;
+        {
+            double t = timePerCall([&]() {
+                pmr::monotonic_buffer_resource resource(arenaBuffer.data(), arenaBuffer.size());
+                PmrStack<T> s(&resource);
+                for (size_t i = 0; i < depth; i++) s.push(T(value));
+                while (!s.empty()) doNotOptimize(s.pop());
+            });
+            arena = depth / t;
+            t = timePerCall([&]() {
+                PmrStack<T> s(&poolResource);
+                for (size_t i = 0; i < depth; i++) s.push(T(value));
+                while (!s.empty()) doNotOptimize(s.pop());
+            });
+            pool = depth / t;
+        }
+        
+        double small = stackRoundTrips<SmallStack<T, 64>>(depth, value,
+            []() { return SmallStack<T, 64>(); },
+            [](SmallStack<T, 64>& s) { return s.pop(); });
+        
+        cout << setw(10) << depth << setw(12) << humanRate(copyTop) << setw(12) << humanRate(movePop)
+             << setw(12) << humanRate(arena) << setw(12) << humanRate(pool)
+             << setw(12) << humanRate(small) << endl;
+    }
+}
+
+void benchStacks() {
+    benchStacksFor<int>("int", 42);
+    benchStacksFor<string>("string", string("a string long enough to skip SSO"));
+}
+
+// Every pushed value must be popped exactly once, with producers and
+// consumers running at the same time
+bool stressConcurrentStack(unsigned producers, unsigned consumers, size_t perProducer) {
+    ConcurrentStack<size_t> stack;
+    size_t total = producers * perProducer;
+    vector<atomic<unsigned char>> seen(total);
+    atomic<size_t> popped{0};
+    atomic<bool> duplicate{false};
+    
+    timeThreads(producers + consumers, [&](unsigned id) {
+        if (id < producers) {
+            for (size_t i = 0; i < perProducer; i++) stack.push(id * perProducer + i);
+            return;
+        }
+        while (popped.load(memory_order_relaxed) < total) {
+            if (auto value = stack.tryPop()) {
+                if (seen[*value].fetch_add(1) != 0) duplicate = true;
+                popped.fetch_add(1, memory_order_relaxed);
+            } else {
+                this_thread::yield();
+            }
+        }
+    });
+    
+    bool allSeen = all_of(seen.begin(), seen.end(), [](const auto& s) { return s.load() == 1; });
+    return !duplicate && allSeen && stack.empty();
+}
+
+void benchConcurrentStack() {
+    cout << "\n--- ConcurrentStack MPMC stress ---" << endl;
+    unsigned half = max(1u, benchConfig.maxThreads / 2);
+    for (auto [producers, consumers] : {pair<unsigned, unsigned>{1, 1}, {half, half}, {1, half * 2}, {half * 2, 1}}) {
+        bool ok = stressConcurrentStack(producers, consumers, 100000);
+        cout << producers << " producers / " << consumers << " consumers: "
+             << (ok ? "PASS" : "FAIL") << endl;
+    }
+    
+    cout << "\n--- Stack push+pop under contention (ops/sec) ---" << endl;
+    cout << setw(8) << "threads" << setw(14) << "mutex Stack" << setw(14) << "lock-free" << endl;
+    size_t ops = min<size_t>(benchConfig.maxN, 2000000);
+    for (unsigned threads : threadSweep()) {
+        size_t perThread = ops / threads / 2;
+        
+        mutex stackMutex;
+        Stack<size_t> locked;
+        double mutexTime = timeThreads(threads, [&](unsigned) {
+            for (size_t i = 0; i < perThread; i++) {
+                {
+                    lock_guard<mutex> lock(stackMutex);
+                    locked.push(i);
+                }
+                lock_guard<mutex> lock(stackMutex);
+                if (!locked.empty()) doNotOptimize(locked.pop());
+            }
+        });
+        
+        ConcurrentStack<size_t> lockFree;
+        double lockFreeTime = timeThreads(threads, [&](unsigned) {
+            for (size_t i = 0; i < perThread; i++) {
+                lockFree.push(i);
+                doNotOptimize(lockFree.tryPop());
+            }
+        });
+        
+        size_t done = perThread * threads * 2;
+        cout << setw(8) << threads << setw(14) << humanRate(done / mutexTime)
+             << setw(14) << humanRate(done / lockFreeTime) << endl;
+    }
+}
+
+void benchFileIO() {
+    // maxN lines of 100 bytes (1 GB at the default max N)
+    const string path = "bench_io.tmp";
+    const string line(99, 'x');
+    size_t lines = benchConfig.maxN;
+    size_t bytes = lines * (line.size() + 1);
+    auto mbps = [bytes](double seconds) {
+        stringstream ss;
+        ss << fixed << setprecision(0) << bytes / seconds / 1e6 << " MB/s";
+        return ss.str();
+    };
+    
+    cout << "\n--- File I/O, " << bytes / 1000000 << " MB text file ---" << endl;
+    cout << "Reads hit the page cache; drop caches first to measure the disk." << endl;
+    
+    double t = timeSeconds([&]() {
+        ofstream out(path);
+        for (size_t i = 0; i < lines; i++) out << line << endl;
+    });
+    cout << setw(28) << left << "write ofstream + endl" << right << mbps(t) << endl;
+    t = timeSeconds([&]() {
+        ofstream out(path);
+        for (size_t i = 0; i < lines; i++) out << line << '\n';
+    });
+    cout << setw(28) << left << "write ofstream + '\\n'" << right << mbps(t) << endl;
+    t = timeSeconds([&]() {
+        BufferedWriter out(path);
+        for (size_t i = 0; i < lines; i++) out.writeLine(line);
+    });
+    cout << setw(28) << left << "write BufferedWriter" << right << mbps(t) << endl;
+    
+    size_t count = 0;
+    t = timeSeconds([&]() {
+        ifstream in(path);
+        string text;
+        count = 0;
+        while (getline(in, text)) count += text.size();
+    });
+    cout << setw(28) << left << "read ifstream getline" << right << mbps(t) << endl;
+    size_t mappedCount = 0;
+    t = timeSeconds([&]() {
+        MappedFile in(path);
+        for (string_view text : in.lines()) mappedCount += text.size();
+    });
+    cout << setw(28) << left << "read MappedFile lines" << right << mbps(t) << endl;
+    if (count != mappedCount) cout << "Line length mismatch!" << endl;
+    
+    unsigned long long sum = 0;
+    t = timeSeconds([&]() {
+        ifstream in(path, ios::binary);
+        vector<uint64_t> chunk(1 << 16);
+        while (in.read(reinterpret_cast<char*>(chunk.data()), chunk.size() * sizeof(uint64_t)) || in.gcount() > 0) {
+            size_t words = in.gcount() / sizeof(uint64_t);
+            for (size_t i = 0; i < words; i++) sum += chunk[i];
+        }
+    });
+    cout << setw(28) << left << "read ifstream::read u64" << right << mbps(t) << endl;
+    unsigned long long mappedSum = 0;
+    t = timeSeconds([&]() {
+        MappedFile in(path);
+        // Whole words only: as<uint64_t>() rejects a file with a partial one
+        span<const uint64_t> words(reinterpret_cast<const uint64_t*>(in.data()), in.size() / sizeof(uint64_t));
+        for (uint64_t word : words) mappedSum += word;
+    });
+    cout << setw(28) << left << "read MappedFile span u64" << right << mbps(t) << endl;
+    if (sum != mappedSum) cout << "Checksum mismatch!" << endl;
+    
+    remove(path.c_str());
+}
+
+void benchParsing() {
+    size_t count = min<size_t>(benchConfig.maxN, 1000000);
+    mt19937_64 rng(7);
+    string ints, doubles;
+    vector<string> intTokens, doubleTokens;
+    for (size_t i = 0; i < count; i++) {
+        long long v = static_cast<long long>(rng() >> (rng() % 60)) * ((i % 2) ? -1 : 1);
+        intTokens.push_back(to_string(v));
+        ints += intTokens.back() + ' ';
+        double d = (rng() % 2000000) / 1000.0 - 1000.0;
+        stringstream ss;
+        ss << setprecision(9) << d;
+        doubleTokens.push_back(ss.str());
+        doubles += doubleTokens.back() + ' ';
+    }
+    
+    cout << "\n--- Parsing " << count << " numbers (MB/s) ---" << endl;
+    cout << setw(10) << "type" << setw(14) << "stringstream" << setw(12) << "stoi/stod"
+         << setw(10) << "sscanf" << setw(12) << "from_chars" << setw(12) << "Tokenizer" << endl;
+    
+    auto row = [&](const char* type, const string& text, const vector<string>& tokens, auto dummy) {
+        using T = decltype(dummy);
+        const bool isInt = is_integral<T>::value;
+        // Integer sums wrap around instead of overflowing a signed type
+        using Sum = typename conditional_t<isInt, make_unsigned<T>, type_identity<T>>::type;
+        auto mbps = [&](double seconds) {
+            stringstream ss;
+            ss << fixed << setprecision(0) << text.size() / seconds / 1e6;
+            return ss.str();
+        };
+        Sum checksum = 0;
+        
+        double streamTime = timePerCall([&]() {
+            stringstream in(text);
+            T v;
+            Sum sum = 0;
+            while (in >> v) sum += v;
+            checksum = sum;
+        });
+        // Works on pre-split strings, so it is spared the tokenizing and copying
+        double stoTime = timePerCall([&]() {
+            Sum sum = 0;
+            for (const auto& token : tokens) sum += isInt ? T(stoll(token)) : T(stod(token));
+            doNotOptimize(sum);
+        });
+        // Also per token: glibc's sscanf runs strlen over the rest of its input
+        double scanfTime = timePerCall([&]() {
+            Sum sum = 0;
+            long long iv;
+            double dv;
+            for (const auto& token : tokens) {
+                if (isInt ? sscanf(token.c_str(), "%lld", &iv) == 1 : sscanf(token.c_str(), "%lf", &dv) == 1) {
+                    sum += isInt ? T(iv) : T(dv);
+                }
+            }
+            doNotOptimize(sum);
+        });
+        double fromCharsTime = timePerCall([&]() {
+            const char* p = text.data();
+            const char* end = p + text.size();
+            Sum sum = 0;
+            T v = 0;
+            while (p < end) {
+                auto r = from_chars(p, end, v);
+                sum += v;
+                p = r.ptr + 1;
+            }
+            doNotOptimize(sum);
+        });
+        Sum ours = 0;
+        double tokenizerTime = timePerCall([&]() {
+            Tokenizer in(text);
+            T v;
+            Sum sum = 0;
+            while (in.next(v)) sum += v;
+            ours = sum;
+        });
+        if (isInt && ours != checksum) cout << "Checksum mismatch!" << endl;
+        
+        cout << setw(10) << type << setw(14) << mbps(streamTime) << setw(12) << mbps(stoTime)
+             << setw(10) << mbps(scanfTime) << setw(12) << mbps(fromCharsTime)
+             << setw(12) << mbps(tokenizerTime) << endl;
+    };
+    row("int64", ints, intTokens, (long long)0);
+    row("double", doubles, doubleTokens, 0.0);
+}
+
+void benchOutput() {
+#if GUIDE_POSIX
+    size_t lines = min<size_t>(benchConfig.maxN, 1000000);
+    cout << "\n--- Formatted output to /dev/null, " << lines << " lines (lines/sec) ---" << endl;
+    
+    double endlTime = timeSilenced([&]() {
+        for (size_t i = 0; i < lines; i++) cout << "Line " << i << " value " << i * 0.5 << " ok" << endl;
+    });
+    double newlineTime = timeSilenced([&]() {
+        for (size_t i = 0; i < lines; i++) cout << "Line " << i << " value " << i * 0.5 << " ok" << '\n';
+    });
+    double printfTime = timeSilenced([&]() {
+        for (size_t i = 0; i < lines; i++) printf("Line %zu value %g ok\n", i, i * 0.5);
+    });
+    double sinkTime = timeSilenced([&]() {
+        for (size_t i = 0; i < lines; i++) fastPrint("Line", i, "value", i * 0.5, "ok");
+        flushOutput();
+    });
+    
+    cout << setw(14) << "cout+endl" << setw(14) << "cout+'\\n'" << setw(14) << "printf"
+         << setw(14) << "fastPrint" << endl;
+    cout << setw(14) << humanRate(lines / endlTime) << setw(14) << humanRate(lines / newlineTime)
+         << setw(14) << humanRate(lines / printfTime) << setw(14) << humanRate(lines / sinkTime) << endl;
+#else
+    cout << "\n--- Formatted output: needs POSIX dup2, skipped ---" << endl;
+#endif
+}
+
+// Async delivery can update one observer from two workers at once, so the
+// add has to be a single atomic read-modify-write or updates get lost
+class CountingObserver : public Observer {
+public:
+    atomic<long long> total{0};
+    void update(int value) override {
+        total.fetch_add(value, memory_order_relaxed);
+    }
+};
+
+void benchObservers() {
+    cout << "\n--- Observer notification ---" << endl;
+    cout << setw(10) << "observers" << setw(14) << "Subject ns" << setw(14) << "CoW ns"
+         << setw(14) << "Subject upd/s" << setw(14) << "CoW upd/s" << setw(14) << "batch64 upd/s"
+         << setw(14) << "async upd/s" << setw(14) << "churn upd/s" << endl;
+    
+    ThreadPool pool(benchConfig.maxThreads);
+    for (size_t count = 10; count <= 100000; count *= 10) {
+        vector<CountingObserver> counters(count);
+        vector<Observer*> pointers;
+        for (auto& c : counters) pointers.push_back(&c);
+        
+        Subject plain;
+        for (auto* p : pointers) plain.addObserver(p);
+        ConcurrentSubject cow;
+        cow.addObservers(pointers);
+        
+        double plainTime = timePerCall([&]() { plain.setState(1); });
+        double cowTime = timePerCall([&]() { cow.setState(1); });
+        
+        array<int, 64> batch;
+        batch.fill(1);
+        double batchTime = timePerCall([&]() { cow.setStates(batch); }) / batch.size();
+        
+        ConcurrentSubject async;
+        async.addObservers(pointers);
+        async.enableAsyncDelivery(pool);
+        double asyncTime = timePerCall([&]() {
+            for (int i = 0; i < 64; i++) async.setState(1);
+            async.waitForDelivery();
+        }) / 64;
+        
+        // Notify while another thread keeps subscribing and unsubscribing
+        CountingObserver extra;
+        atomic<bool> churning{true};
+        thread churn([&]() {
+            while (churning.load()) {
+                cow.addObserver(&extra);
+                cow.removeObserver(&extra);
+            }
+        });
+        double churnTime = timePerCall([&]() { cow.setState(1); });
+        churning = false;
+        churn.join();
+        
+        cout << setw(10) << count
+             << setw(14) << (long long)(plainTime * 1e9) << setw(14) << (long long)(cowTime * 1e9)
+             << setw(14) << humanRate(count / plainTime) << setw(14) << humanRate(count / cowTime)
+             << setw(14) << humanRate(count / batchTime) << setw(14) << humanRate(count / asyncTime)
+             << setw(14) << humanRate(count / churnTime) << endl;
+    }
+}
+
+void benchEventBus() {
+    cout << "\n--- Event bus (4 subscribers, 4096-slot queues, batch 64) ---" << endl;
+    cout << setw(10) << "producers" << setw(13) << "policy" << setw(14) << "events/s"
+         << setw(12) << "dropped" << setw(12) << "p50 ns" << setw(12) << "p99 ns"
+         << setw(12) << "p99.9 ns" << endl;
+    
+    const size_t events = min<size_t>(benchConfig.maxN, 2000000);
+    const pair<Backpressure, const char*> policies[] = {
+        {Backpressure::BLOCK, "block"},
+        {Backpressure::DROP_OLDEST, "drop-oldest"},
+        {Backpressure::DROP_NEWEST, "drop-newest"},
+    };
+    for (unsigned producers : {1u, 4u, 16u}) {
+        for (const auto& [policy, name] : policies) {
+            vector<CountingObserver> counters(4);
+            EventBus bus(4096, policy, 64);
+            for (auto& c : counters) bus.subscribe(&c);
+            bus.start();
+            
+            size_t perProducer = events / producers;
+            double seconds = timeSeconds([&]() {
+                timeThreads(producers, [&](unsigned) {
+                    for (size_t i = 0; i < perProducer; i++) bus.publish(1);
+                });
+                bus.stop();
+            });
+            
+            const LatencyHistogram& latency = bus.latency();
+            cout << setw(10) << producers << setw(13) << name
+                 << setw(14) << humanRate(perProducer * producers / seconds)
+                 << setw(12) << bus.dropped()
+                 << setw(12) << latency.percentile(50) << setw(12) << latency.percentile(99)
+                 << setw(12) << latency.percentile(99.9) << endl;
+        }
+    }
+}
+
+// Slow constructor widens the window in which first calls can race
+class StressSingleton : public SingletonBase<StressSingleton> {
+private:
+    friend class SingletonBase<StressSingleton>;
+    StressSingleton() {
+        constructions.fetch_add(1);
+        this_thread::sleep_for(chrono::milliseconds(20));
+        ready = true;
+    }
+    
+public:
+    static inline atomic<int> constructions{0};
+    bool ready = false;
+};
+
+// The unsynchronized lazy pointer this replaced, made race-free with a lock
+class LockedSingleton {
+private:
+    static inline mutex lock;
+    static inline LockedSingleton* instance = nullptr;
+    
+public:
+    static LockedSingleton* getInstance() {
+        lock_guard<mutex> guard(lock);
+        if (instance == nullptr) {
+            instance = new LockedSingleton();
+        }
+        return instance;
+    }
+};
+
+class OnceSingleton {
+private:
+    static inline once_flag flag;
+    static inline OnceSingleton* instance = nullptr;
+    
+public:
+    static OnceSingleton* getInstance() {
+        call_once(flag, []() { instance = new OnceSingleton(); });
+        return instance;
+    }
+};
+
+void benchSingleton() {
+    cout << "\n--- Singleton access ---" << endl;
+    
+    // All threads are released together into the first-ever call
+    const unsigned stressThreads = 32;
+    atomic<unsigned> waiting{stressThreads};
+    vector<StressSingleton*> seen(stressThreads);
+    bool allReady = true;
+    mutex readyLock;
+    timeThreads(stressThreads, [&](unsigned t) {
+        waiting.fetch_sub(1);
+        while (waiting.load() != 0) this_thread::yield();
+        StressSingleton* s = StressSingleton::getInstance();
+        seen[t] = s;
+        lock_guard<mutex> guard(readyLock);
+        allReady &= s->ready;
+    });
+    bool sameInstance = all_of(seen.begin(), seen.end(), [&](auto* s) { return s == seen[0]; });
+    bool pass = sameInstance && allReady && StressSingleton::constructions.load() == 1;
+    cout << "Stress (" << stressThreads << " threads racing first call): "
+         << StressSingleton::constructions.load() << " construction(s) -> "
+         << (pass ? "PASS" : "FAIL") << endl;
+    
+    cout << setw(8) << "threads" << setw(14) << "mutex" << setw(14) << "call_once"
+         << setw(14) << "static" << setw(14) << "thread_local" << "  (calls/sec)" << endl;
+    const size_t calls = max<size_t>(1, min<size_t>(benchConfig.maxN, 10000000));
+    for (unsigned threads : {1u, 4u, 32u}) {
+        auto rate = [&](auto getInstance) {
+            size_t perThread = calls / threads;
+            double seconds = timeThreads(threads, [&](unsigned) {
+                for (size_t i = 0; i < perThread; i++) {
+                    doNotOptimize(getInstance());
+                }
+            });
+            return humanRate(perThread * threads / seconds);
+        };
+        cout << setw(8) << threads
+             << setw(14) << rate([]() { return LockedSingleton::getInstance(); })
+             << setw(14) << rate([]() { return OnceSingleton::getInstance(); })
+             << setw(14) << rate([]() { return Singleton::getInstance(); })
+             << setw(14) << rate([]() { return ThreadScratch::getInstance(); }) << endl;
+    }
+}
+
+void benchFactories() {
+    cout << "\n--- Factory create + use (price()) ---" << endl;
+    cout << setw(12) << "factory" << setw(12) << "ns/cycle" << setw(14) << "cycles/s" << endl;
+    
+    // Random mix so the branch on type cannot be predicted away
+    const size_t cycles = max<size_t>(1, min<size_t>(benchConfig.maxN, 10000000));
+    vector<Factory::ProductType> types(4096);
+    mt19937 rng(7);
+    for (auto& t : types) t = (rng() & 1) ? Factory::TYPE_A : Factory::TYPE_B;
+    
+    auto report = [&](const char* name, auto body) {
+        double total = 0;
+        double seconds = timeSeconds([&]() {
+            for (size_t i = 0; i < cycles; i++) {
+                total += body(types[i & (types.size() - 1)]);
+            }
+        });
+        doNotOptimize(total);
+        stringstream ns;
+        ns << fixed << setprecision(2) << seconds * 1e9 / cycles;
+        cout << setw(12) << name << setw(12) << ns.str()
+             << setw(14) << humanRate(cycles / seconds) << endl;
+    };
+    
+    report("heap", [](Factory::ProductType type) {
+        auto product = Factory::createProduct(type);
+        return product->price();
+    });
+    PooledFactory pool;
+    report("pooled", [&](Factory::ProductType type) {
+        auto product = pool.createProduct(type);
+        return product->price();
+    });
+    report("variant", [](Factory::ProductType type) {
+        ProductVariant product = StaticFactory::createProduct(type);
+        return StaticFactory::price(product);
+    });
+}
+
+// One create/copy/move/assign/destroy cycle, the pattern of createMovableObject()
+template<typename Movable>
+double movableCycleSeconds(size_t elements, size_t iterations, unsigned threads) {
+    Movable::verbose = false;
+    size_t perThread = iterations / threads;
+    double seconds = timeThreads(threads, [&](unsigned) {
+        for (size_t i = 0; i < perThread; i++) {
+            Movable a(elements);
+            Movable b(a);
+            Movable c(move(b));
+            b = a;
+            a = move(c);
+            doNotOptimize(a.getData());
+        }
+    });
+    Movable::verbose = true;
+    return seconds / (perThread * threads);
+}
+
+void benchBufferPool() {
+    cout << "\n--- MovableClass buffers: new/delete vs BufferPool (ns per cycle) ---" << endl;
+    cout << setw(8) << "threads" << setw(10) << "ints" << setw(12) << "new/delete"
+         << setw(12) << "pooled" << setw(10) << "speedup" << setw(12) << "saved" << endl;
+    
+    for (unsigned threads : {1u, benchConfig.maxThreads}) {
+        for (size_t elements : {16, 256, 4096, 65536}) {
+            size_t iterations = max<size_t>(threads, min<size_t>(benchConfig.maxN, 20000000 / elements));
+            double heap = movableCycleSeconds<HeapMovableClass>(elements, iterations, threads);
+            BufferPool::Stats before = BufferPool::stats();
+            double pooled = movableCycleSeconds<MovableClass>(elements, iterations, threads);
+            BufferPool::Stats after = BufferPool::stats();
+            
+            uint64_t requests = after.requests - before.requests;
+            uint64_t saved = after.saved() - before.saved();
+            stringstream speedup, savedShare;
+            speedup << fixed << setprecision(2) << heap / pooled << "x";
+            savedShare << fixed << setprecision(1) << 100.0 * saved / max<uint64_t>(1, requests) << "%";
+            cout << setw(8) << threads << setw(10) << elements
+                 << setw(12) << (long long)(heap * 1e9) << setw(12) << (long long)(pooled * 1e9)
+                 << setw(10) << speedup.str() << setw(12) << savedShare.str() << endl;
+        }
+        if (benchConfig.maxThreads == 1) break;
+    }
+    
+    BufferPool::Stats total = BufferPool::stats();
+    cout << "Pool totals: " << total.requests << " requests, " << total.threadHits
+         << " thread-local hits, " << total.sharedHits << " shared refills, "
+         << total.heapAllocations << " heap allocations" << endl;
+}
+
+void benchSmallBuffer() {
+    using Small = SmallMovableClass<8>;
+    cout << "\n--- MovableClass vs SmallMovableClass<" << Small::inlineCapacity()
+         << "> (ns per operation) ---" << endl;
+    cout << setw(8) << "ints" << setw(10) << "storage" << setw(12) << "heap ctor" << setw(12) << "pool ctor"
+         << setw(12) << "sbo ctor" << setw(12) << "heap move" << setw(12) << "pool move"
+         << setw(12) << "sbo move" << endl;
+    
+    HeapMovableClass::verbose = false;
+    MovableClass::verbose = false;
+    const size_t iterations = max<size_t>(1, min<size_t>(benchConfig.maxN, 5000000));
+    
+    // Construct and destroy
+    auto construct = [&](auto tag, size_t elements) {
+        using Movable = typename decltype(tag)::type;
+        size_t loops = max<size_t>(1, iterations * 8 / max<size_t>(8, elements));
+        return timeSeconds([&]() {
+            for (size_t i = 0; i < loops; i++) {
+                Movable m(elements);
+                doNotOptimize(m);
+            }
+        }) / loops;
+    };
+    
+    // Move back and forth between two objects
+    auto moveCost = [&](auto tag, size_t elements) {
+        using Movable = typename decltype(tag)::type;
+        Movable a(elements);
+        Movable b(0);
+        double seconds = timeSeconds([&]() {
+            for (size_t i = 0; i < iterations; i++) {
+                b = move(a);
+                a = move(b);
+                doNotOptimize(a);
+            }
+        });
+        return seconds / (2 * iterations);
+    };
+    
+    auto ns = [](double seconds) {
+        stringstream ss;
+        ss << fixed << setprecision(1) << seconds * 1e9;
+        return ss.str();
+    };
+    
+    for (size_t elements : {3, 5, 8, 9, 64, 1024}) {
+        cout << setw(8) << elements << setw(10) << (elements <= Small::inlineCapacity() ? "inline" : "heap")
+             << setw(12) << ns(construct(type_identity<HeapMovableClass>{}, elements))
+             << setw(12) << ns(construct(type_identity<MovableClass>{}, elements))
+             << setw(12) << ns(construct(type_identity<Small>{}, elements))
+             << setw(12) << ns(moveCost(type_identity<HeapMovableClass>{}, elements))
+             << setw(12) << ns(moveCost(type_identity<MovableClass>{}, elements))
+             << setw(12) << ns(moveCost(type_identity<Small>{}, elements)) << endl;
+    }
+    
+    HeapMovableClass::verbose = true;
+    MovableClass::verbose = true;
+}
+
+// Grows a vector one push_back at a time, then destroys it
+template<typename R, typename Timer>
+pair<double, double> rectangleVectorSeconds(size_t count, Timer timer) {
+    vector<R>* rects = new vector<R>();
+    double grow = timer([&]() {
+        for (size_t i = 0; i < count; i++) {
+            rects->emplace_back(double(i & 1023), 2.0);
+        }
+    });
+    doNotOptimize(rects->back());
+    double destroy = timer([&]() { delete rects; });
+    return {grow, destroy};
+}
+
+void benchRectangles() {
+    const size_t count = min<size_t>(benchConfig.maxN, 10000000);
+    cout << "\n--- vector<Rectangle> growth and destruction ---" << endl;
+    cout << setw(12) << "lifecycle" << setw(12) << "elements" << setw(12) << "grow ms"
+         << setw(12) << "destroy ms" << setw(14) << "grow ns/elem" << setw(16) << "destroy ns/elem" << endl;
+    
+    auto report = [](const char* name, size_t n, pair<double, double> t) {
+        stringstream growNs, destroyNs;
+        growNs << fixed << setprecision(2) << t.first * 1e9 / n;
+        destroyNs << fixed << setprecision(2) << t.second * 1e9 / n;
+        cout << setw(12) << name << setw(12) << n
+             << setw(12) << (long long)(t.first * 1e3) << setw(12) << (long long)(t.second * 1e3)
+             << setw(14) << growNs.str() << setw(16) << destroyNs.str() << endl;
+    };
+    
+    auto timer = [](auto body) { return timeSeconds(body); };
+    report("trivial", count, rectangleVectorSeconds<Rectangle>(count, timer));
+    report("counted", count, rectangleVectorSeconds<CountedRectangle>(count, timer));
+#if GUIDE_POSIX
+    // One flushed line per destruction; a smaller run is enough to see the rate
+    size_t logged = min<size_t>(count, 1000000);
+    auto silencedTimer = [](auto body) { return timeSilenced(body); };
+    report("logged", logged, rectangleVectorSeconds<LoggedRectangle>(logged, silencedTimer));
+#endif
+    cout << "Counted rectangles alive afterwards: " << CountedRectangle::getObjectCount() << endl;
+}
+
+void benchGeometry() {
+    vector<const GeometryKernels*> levels = {&geometryKernels(SimdLevel::SCALAR)};
+    SimdLevel best = detectSimdLevel();
+    if (best >= SimdLevel::AVX2) levels.push_back(&geometryKernels(SimdLevel::AVX2));
+    if (best >= SimdLevel::AVX512) levels.push_back(&geometryKernels(SimdLevel::AVX512));
+    
+    // Accuracy: every level against the member functions, on odd sizes for the tails
+    mt19937_64 rng(19);
+    uniform_real_distribution<double> dist(0.0, 1000.0);
+    size_t checkSize = 1003;
+    vector<double> w(checkSize), h(checkSize), r(checkSize);
+    for (size_t i = 0; i < checkSize; i++) {
+        w[i] = dist(rng);
+        h[i] = dist(rng);
+        r[i] = dist(rng);
+    }
+    cout << "\n--- Batched geometry accuracy (max |batch - member| / member) ---" << endl;
+    for (const GeometryKernels* k : levels) {
+        vector<double> ra(checkSize), rp(checkSize), ca(checkSize), cp(checkSize);
+        k->rectangles(w.data(), h.data(), ra.data(), rp.data(), checkSize);
+        k->circles(r.data(), ca.data(), cp.data(), checkSize);
+        double worst = 0;
+        for (size_t i = 0; i < checkSize; i++) {
+            Rectangle rect(w[i], h[i]);
+            Circle circle(r[i]);
+            worst = max({worst, abs(ra[i] - rect.area()) / rect.area(),
+                         abs(rp[i] - rect.perimeter()) / rect.perimeter(),
+                         abs(ca[i] - circle.area()) / circle.area(),
+                         abs(cp[i] - circle.perimeter()) / circle.perimeter()});
+        }
+        cout << setw(10) << k->name << "  " << worst << (worst == 0 ? "  (exact)" : "") << endl;
+    }
+    
+    cout << "\n--- Batched geometry throughput (shapes/sec) ---" << endl;
+    cout << setw(10) << "shapes" << setw(14) << "rect members" << setw(14) << "circ members";
+    for (const GeometryKernels* k : levels) {
+        cout << setw(10) << (string(k->name) + " R") << setw(10) << (string(k->name) + " C");
+    }
+    cout << endl;
+    
+    for (size_t n : sizeSweep()) {
+        vector<double> widths(n), heights(n), radii(n), areas(n), perimeters(n);
+        for (size_t i = 0; i < n; i++) {
+            widths[i] = 1.0 + (i & 255);
+            heights[i] = 2.0 + (i & 127);
+            radii[i] = 0.5 + (i & 63);
+        }
+        cout << setw(10) << n;
+        
+        // One object at a time through the member functions; circles carry a
+        // string, so stop at 10^6 of them
+        vector<Rectangle> rects;
+        rects.reserve(n);
+        for (size_t i = 0; i < n; i++) rects.emplace_back(widths[i], heights[i]);
+        double rectTime = timePerCall([&]() {
+            for (size_t i = 0; i < n; i++) {
+                areas[i] = rects[i].area();
+                perimeters[i] = rects[i].perimeter();
+            }
+            doNotOptimize(areas[n - 1]);
+        });
+        cout << setw(14) << humanRate(n / rectTime);
+        if (n <= 1000000) {
+            vector<Circle> circles;
+            circles.reserve(n);
+            for (size_t i = 0; i < n; i++) circles.emplace_back(radii[i]);
+            double circleTime = timePerCall([&]() {
+                for (size_t i = 0; i < n; i++) {
+                    areas[i] = circles[i].area();
+                    perimeters[i] = circles[i].perimeter();
+                }
+                doNotOptimize(areas[n - 1]);
+            });
+            cout << setw(14) << humanRate(n / circleTime);
+        } else {
+            cout << setw(14) << "-";
+        }
+        
+        for (const GeometryKernels* k : levels) {
+            double rt = timePerCall([&]() {
+                k->rectangles(widths.data(), heights.data(), areas.data(), perimeters.data(), n);
+                doNotOptimize(areas[n - 1]);
+            });
+            double ct = timePerCall([&]() {
+                k->circles(radii.data(), areas.data(), perimeters.data(), n);
+                doNotOptimize(areas[n - 1]);
+            });
+            cout << setw(10) << humanRate(n / rt) << setw(10) << humanRate(n / ct);
+        }
+        cout << endl;
+    }
+}
 
-// 15.3 SFINAE (Substitution Failure Is Not An Error)
-template<typename T>
-typename enable_if<is_integral<T>::value, T>::type
-safeAdd(T a, T b) {
-    return a + b;
+// Random circles and rectangles at a constant density of one per 100 units^2
+vector<PlacedShape> randomPlacedShapes(size_t n, double side, mt19937_64& rng) {
+    uniform_real_distribution<double> position(0, side), extent(0.5, 5.0);
+    vector<PlacedShape> shapes;
+    shapes.reserve(n);
+    for (size_t i = 0; i < n; i++) {
+        uint32_t id = static_cast<uint32_t>(i);
+        if (i & 1) {
+            shapes.push_back(PlacedShape::circle(id, position(rng), position(rng), extent(rng)));
+        } else {
+            shapes.push_back(PlacedShape::rectangle(id, position(rng), position(rng), 2 * extent(rng), 2 * extent(rng)));
+        }
+    }
+    return shapes;
 }
 
-template<typename T>
-typename enable_if<is_floating_point<T>::value, T>::type
-safeAdd(T a, T b) {
-    return a + b + 0.001;  // Add small epsilon for floating point
+vector<uint32_t> linearRange(const vector<PlacedShape>& shapes, const BoundingBox& query) {
+    vector<uint32_t> result;
+    for (const auto& shape : shapes) {
+        if (shape.bounds().intersects(query)) result.push_back(shape.id);
+    }
+    return result;
 }
 
-// 15.4 Variadic Templates (C++11)
-template<typename T>
-void print(const T& value) {
-    cout << value << endl;
+vector<pair<double, uint32_t>> linearNearest(const vector<PlacedShape>& shapes, double x, double y, size_t k) {
+    vector<pair<double, uint32_t>> all;
+    all.reserve(shapes.size());
+    for (const auto& shape : shapes) all.push_back({shape.distanceSquared(x, y), shape.id});
+    k = min(k, all.size());
+    partial_sort(all.begin(), all.begin() + k, all.end());
+    all.resize(k);
+    for (auto& entry : all) entry.first = sqrt(entry.first);
+    return all;
 }
 
-template<typename T, typename... Args>
-void print(const T& first, const Args&... args) {
-    cout << first << " ";
-    print(args...);  // Recursive call
+void benchSpatialIndex() {
+    mt19937_64 rng(20);
+    
+    // Correctness: index (with pending inserts and erases) vs linear scan
+    {
+        double side = 1000;
+        vector<PlacedShape> shapes = randomPlacedShapes(20000, side, rng);
+        SpatialIndex index(vector<PlacedShape>(shapes.begin(), shapes.begin() + 15000));
+        for (size_t i = 15000; i < shapes.size(); i++) index.insert(shapes[i]);
+        for (size_t i = 0; i < shapes.size(); i += 3) index.erase(shapes[i]);
+        vector<PlacedShape> live;
+        for (size_t i = 0; i < shapes.size(); i++) {
+            if (i % 3 != 0) live.push_back(shapes[i]);
+        }
+        
+        uniform_real_distribution<double> point(0, side);
+        bool pass = index.size() == live.size();
+        for (int q = 0; q < 200 && pass; q++) {
+            double x = point(rng), y = point(rng);
+            BoundingBox box{x, y, x + 40, y + 40};
+            vector<uint32_t> expected = linearRange(live, box), actual = index.range(box);
+            sort(expected.begin(), expected.end());
+            sort(actual.begin(), actual.end());
+            auto nearExpected = linearNearest(live, x, y, 10);
+            auto nearActual = index.nearest(x, y, 10);
+            pass = expected == actual && nearActual.size() == nearExpected.size();
+            for (size_t i = 0; pass && i < nearActual.size(); i++) {
+                pass = nearActual[i].first == nearExpected[i].first;
+            }
+        }
+        cout << "\nSpatial index check (range + 10-nearest vs linear scan, after inserts/erases): "
+             << (pass ? "PASS" : "FAIL") << endl;
+    }
+    
+    cout << "\n--- Spatial index vs linear scan (us per query; 50x50 range, 10-nearest) ---" << endl;
+    cout << setw(10) << "shapes" << setw(10) << "build ms" << setw(12) << "range idx" << setw(12) << "range scan"
+         << setw(12) << "knn idx" << setw(12) << "knn scan" << setw(12) << "insert us" << setw(12) << "erase us" << endl;
+    
+    for (size_t n : sizeSweep(10000)) {
+        double side = sqrt(double(n)) * 10;
+        vector<PlacedShape> shapes = randomPlacedShapes(n, side, rng);
+        SpatialIndex index;
+        double buildTime = timeSeconds([&]() { index.build(shapes); });
+        
+        uniform_real_distribution<double> point(0, side);
+        vector<pair<double, double>> queries(256);
+        for (auto& q : queries) q = {point(rng), point(rng)};
+        size_t next = 0;
+        auto query = [&]() { return queries[next++ & 255]; };
+        
+        auto us = [](double seconds) {
+            stringstream ss;
+            ss << fixed << setprecision(seconds < 1e-4 ? 2 : 0) << seconds * 1e6;
+            return ss.str();
+        };
+        double rangeIndex = timePerCall([&]() {
+            auto [x, y] = query();
+            doNotOptimize(index.range({x, y, x + 50, y + 50}).size());
+        });
+        double rangeScan = timePerCall([&]() {
+            auto [x, y] = query();
+            doNotOptimize(linearRange(shapes, {x, y, x + 50, y + 50}).size());
+        });
+        double knnIndex = timePerCall([&]() {
+            auto [x, y] = query();
+            doNotOptimize(index.nearest(x, y, 10).size());
+        });
+        double knnScan = timePerCall([&]() {
+            auto [x, y] = query();
+            doNotOptimize(linearNearest(shapes, x, y, 10).size());
+        });
+        
+        // Churn: add 1000 new shapes, then remove them again
+        vector<PlacedShape> extra = randomPlacedShapes(1000, side, rng);
+        for (auto& shape : extra) shape.id += static_cast<uint32_t>(n);
+        double insertTime = timeSeconds([&]() {
+            for (const auto& shape : extra) index.insert(shape);
+        }) / extra.size();
+        double eraseTime = timeSeconds([&]() {
+            for (const auto& shape : extra) index.erase(shape);
+        }) / extra.size();
+        
+        cout << setw(10) << n << setw(10) << (long long)(buildTime * 1e3)
+             << setw(12) << us(rangeIndex) << setw(12) << us(rangeScan)
+             << setw(12) << us(knnIndex) << setw(12) << us(knnScan)
+             << setw(12) << us(insertTime) << setw(12) << us(eraseTime) << endl;
+    }
 }
 
-// 15.5 Type Traits
-template<typename T>
-void analyzeType(const T& value) {
-    cout << "\nType analysis:" << endl;
-    cout << "Is integral: " << boolalpha << is_integral<T>::value << endl;
-    cout << "Is floating point: " << is_floating_point<T>::value << endl;
-    cout << "Is pointer: " << is_pointer<T>::value << endl;
-    cout << "Is reference: " << is_reference<T>::value << endl;
-    cout << "Size: " << sizeof(T) << " bytes" << endl;
+// ns per operation for insert, successful find, erase, and per element to iterate
+template<typename Container, typename Insert>
+array<double, 4> hashContainerTimes(const vector<uint64_t>& keys, const vector<uint64_t>& lookups, Insert insert) {
+    array<double, 4> ns{};
+    Container c;
+    ns[0] = timeSeconds([&]() {
+        for (uint64_t k : keys) insert(c, k);
+    }) * 1e9 / keys.size();
+    size_t hits = 0;
+    ns[1] = timeSeconds([&]() {
+        for (uint64_t k : lookups) hits += c.find(k) != c.end();
+    }) * 1e9 / lookups.size();
+    doNotOptimize(hits);
+    uint64_t total = 0;
+    ns[3] = timeSeconds([&]() {
+        for (const auto& entry : c) {
+            if constexpr (is_same_v<decay_t<decltype(entry)>, uint64_t>) total += entry;
+            else total += entry.first;
+        }
+    }) * 1e9 / keys.size();
+    doNotOptimize(total);
+    ns[2] = timeSeconds([&]() {
+        for (uint64_t k : keys) c.erase(k);
+    }) * 1e9 / keys.size();
+    return ns;
 }
 
-void advancedTopics() {
-    cout << "\n=== ADVANCED TOPICS ===" << endl;
-    
-    // Function objects
-    cout << "--- Function Objects ---" << endl;
-    Multiplier times3(3);
-    cout << "5 * 3 = " << times3(5) << endl;
+void benchHashMaps() {
+    cout << "\n--- Hash map vs tree containers (ns per insert / find / erase / iterated element) ---" << endl;
+    cout << setw(12) << "keys" << setw(16) << "container" << setw(10) << "insert" << setw(10) << "find"
+         << setw(10) << "erase" << setw(10) << "iterate" << endl;
+    
+    mt19937_64 rng(21);
+    for (size_t n : sizeSweep()) {
+        vector<uint64_t> keys(n);
+        for (auto& k : keys) k = rng();
+        vector<uint64_t> lookups(min<size_t>(n, 1000000));
+        for (auto& k : lookups) k = keys[rng() % n];
+        
+        auto print = [&](const char* name, array<double, 4> ns) {
+            cout << setw(12) << n << setw(16) << name;
+            for (double v : ns) {
+                stringstream ss;
+                ss << fixed << setprecision(1) << v;
+                cout << setw(10) << ss.str();
+            }
+            cout << endl;
+        };
+        auto mapInsert = [](auto& c, uint64_t k) { c[k] = k; };
+        auto setInsert = [](auto& c, uint64_t k) { c.insert(k); };
+        print("map", hashContainerTimes<map<uint64_t, uint64_t>>(keys, lookups, mapInsert));
+        print("unordered_map", hashContainerTimes<unordered_map<uint64_t, uint64_t>>(keys, lookups, mapInsert));
+        print("FlatHashMap", hashContainerTimes<FlatHashMap<uint64_t, uint64_t>>(keys, lookups, mapInsert));
+        print("set", hashContainerTimes<set<uint64_t>>(keys, lookups, setInsert));
+        print("unordered_set", hashContainerTimes<unordered_set<uint64_t>>(keys, lookups, setInsert));
+        print("FlatHashSet", hashContainerTimes<FlatHashSet<uint64_t>>(keys, lookups, setInsert));
+    }
     
-    vector<int> nums = {1, 2, 3, 4, 5};
-    transform(nums.begin(), nums.end(), nums.begin(), times3);
-    cout << "After multiplication by 3: ";
-    for (auto n : nums) cout << n << " ";
-    cout << endl;
+    // String keys looked up through string_view: no temporary string per find
+    size_t n = min<size_t>(benchConfig.maxN, 1000000);
+    vector<string> names(n);
+    for (size_t i = 0; i < n; i++) names[i] = "customer-" + to_string(rng());
+    vector<string_view> probes(n);
+    for (size_t i = 0; i < n; i++) probes[i] = names[rng() % n];
+    unordered_map<string, int> stdNames;
+    FlatHashMap<string, int> flatNames;
+    flatNames.reserve(n);
+    for (size_t i = 0; i < n; i++) {
+        stdNames[names[i]] = int(i);
+        flatNames[names[i]] = int(i);
+    }
+    size_t hits = 0;
+    double stdTime = timeSeconds([&]() {
+        for (string_view p : probes) hits += stdNames.count(string(p));
+    });
+    double flatTime = timeSeconds([&]() {
+        for (string_view p : probes) hits += flatNames.contains(p);
+    });
+    doNotOptimize(hits);
+    cout << "string_view lookups over " << n << " string keys: unordered_map "
+         << (long long)(stdTime * 1e9 / n) << " ns, FlatHashMap " << (long long)(flatTime * 1e9 / n) << " ns" << endl;
+}
+
+// Tallies the bytes a container asks for (allocator overhead not included)
+template<typename T>
+struct CountingAllocator {
+    using value_type = T;
+    size_t* bytes;
     
-    // Template metaprogramming
-    cout << "\n--- Template Metaprogramming ---" << endl;
-    cout << "Factorial<5>::value = " << Factorial<5>::value << endl;
+    explicit CountingAllocator(size_t* counter) : bytes(counter) {}
+    template<typename U>
+    CountingAllocator(const CountingAllocator<U>& other) : bytes(other.bytes) {}
     
-    // SFINAE
-    cout << "\n--- SFINAE ---" << endl;
-    cout << "safeAdd(5, 3) = " << safeAdd(5, 3) << endl;
-    cout << "safeAdd(5.5, 3.2) = " << safeAdd(5.5, 3.2) << endl;
+    T* allocate(size_t n) {
+        *bytes += n * sizeof(T);
+        return allocator<T>().allocate(n);
+    }
     
-    // Variadic templates
-    cout << "\n--- Variadic Templates ---" << endl;
-    print("Hello", 42, 3.14, "World", true);
+    void deallocate(T* p, size_t n) {
+        *bytes -= n * sizeof(T);
+        allocator<T>().deallocate(p, n);
+    }
     
-    // Type traits
-    analyzeType(42);
-    analyzeType(3.14);
-    int* ptr = nullptr;
-    analyzeType(ptr);
+    template<typename U>
+    bool operator==(const CountingAllocator<U>& other) const { return bytes == other.bytes; }
+};
+
+void benchFlatMaps() {
+    cout << "\n--- Sorted flat containers vs trees (build ms, ns per lookup, ns per iterated element, bytes/entry) ---" << endl;
+    cout << setw(10) << "keys" << setw(22) << "container" << setw(10) << "build" << setw(10) << "lookup"
+         << setw(10) << "iterate" << setw(12) << "bytes" << endl;
+    
+    mt19937_64 rng(22);
+    for (size_t n : sizeSweep()) {
+        vector<pair<uint64_t, uint64_t>> entries(n);
+        for (auto& e : entries) e = {rng(), rng()};
+        vector<uint64_t> lookups(1000000);
+        for (auto& k : lookups) k = entries[rng() % n].first;
+        
+        auto print = [&](const char* name, double build, double lookup, double iterate, double bytes) {
+            stringstream b, l, it, mem;
+            b << fixed << setprecision(1) << build * 1e3;
+            l << fixed << setprecision(1) << lookup * 1e9 / lookups.size();
+            it << fixed << setprecision(2) << iterate * 1e9 / n;
+            mem << fixed << setprecision(1) << bytes / n;
+            cout << setw(10) << n << setw(22) << name << setw(10) << b.str() << setw(10) << l.str()
+                 << setw(10) << it.str() << setw(12) << mem.str() << endl;
+        };
+        uint64_t sink = 0;
+        
+        {
+            size_t bytes = 0;
+            using Alloc = CountingAllocator<pair<const uint64_t, uint64_t>>;
+            map<uint64_t, uint64_t, less<>, Alloc> tree{Alloc(&bytes)};
+            double build = timeSeconds([&]() {
+                for (const auto& [k, v] : entries) tree.emplace(k, v);
+            });
+            double lookup = timeSeconds([&]() {
+                for (uint64_t k : lookups) sink += tree.find(k)->second;
+            });
+            double iterate = timeSeconds([&]() {
+                for (const auto& entry : tree) sink += entry.second;
+            });
+            print("map", build, lookup, iterate, bytes);
+        }
+        {
+            FlatMap<uint64_t, uint64_t> flat;
+            double build = timeSeconds([&]() { flat = FlatMap<uint64_t, uint64_t>::fromUnsorted(entries); });
+            double lookup = timeSeconds([&]() {
+                for (uint64_t k : lookups) sink += *flat.lookup(k);
+            });
+            double iterate = timeSeconds([&]() {
+                for (uint64_t v : flat.values()) sink += v;
+            });
+            print("FlatMap", build, lookup, iterate, double(flat.size()) * (sizeof(uint64_t) * 2));
+        }
+        
+        vector<uint64_t> keys(n);
+        for (size_t i = 0; i < n; i++) keys[i] = entries[i].first;
+        {
+            size_t bytes = 0;
+            using Alloc = CountingAllocator<uint64_t>;
+            set<uint64_t, less<>, Alloc> tree{Alloc(&bytes)};
+            double build = timeSeconds([&]() {
+                for (uint64_t k : keys) tree.insert(k);
+            });
+            double lookup = timeSeconds([&]() {
+                for (uint64_t k : lookups) sink += tree.count(k);
+            });
+            double iterate = timeSeconds([&]() {
+                for (uint64_t k : tree) sink += k;
+            });
+            print("set", build, lookup, iterate, bytes);
+        }
+        {
+            FlatSet<uint64_t> flat;
+            double build = timeSeconds([&]() { flat = FlatSet<uint64_t>::fromUnsorted(keys); });
+            double lookup = timeSeconds([&]() {
+                for (uint64_t k : lookups) sink += flat.contains(k);
+            });
+            double iterate = timeSeconds([&]() {
+                for (uint64_t k : flat) sink += k;
+            });
+            print("FlatSet", build, lookup, iterate, double(flat.size()) * sizeof(uint64_t));
+            
+            // Same array searched with the branching std::binary_search
+            span<const uint64_t> sorted = flat.values();
+            double branching = timeSeconds([&]() {
+                for (uint64_t k : lookups) sink += binary_search(sorted.begin(), sorted.end(), k);
+            });
+            print("sorted vector (std)", 0, branching, iterate, double(flat.size()) * sizeof(uint64_t));
+        }
+        doNotOptimize(sink);
+    }
 }
 
-/*
-===============================================================================
-                            16. DESIGN PATTERNS
-===============================================================================
-*/
+// ns per push_back, push_front, iterated element and insert at a held middle
+// iterator; NaN where the container has no cheap way to do it
+template<typename Container>
+array<double, 4> sequenceTimes(size_t n, size_t middleInserts) {
+    array<double, 4> ns{};
+    {
+        Container c;
+        ns[0] = timeSeconds([&]() {
+            for (size_t i = 0; i < n; i++) c.push_back(i);
+        }) * 1e9 / n;
+        uint64_t total = 0;
+        ns[2] = timeSeconds([&]() {
+            for (uint64_t v : c) total += v;
+        }) * 1e9 / n;
+        doNotOptimize(total);
+        
+        auto it = next(c.begin(), n / 2);
+        ns[3] = timeSeconds([&]() {
+            for (size_t i = 0; i < middleInserts; i++) it = c.insert(it, i);
+        }) * 1e9 / middleInserts;
+        doNotOptimize(c.size());
+    }
+    if constexpr (requires(Container c) { c.push_front(0); }) {
+        Container c;
+        ns[1] = timeSeconds([&]() {
+            for (size_t i = 0; i < n; i++) c.push_front(i);
+        }) * 1e9 / n;
+        doNotOptimize(c.size());
+    } else {
+        ns[1] = numeric_limits<double>::quiet_NaN();
+    }
+    return ns;
+}
 
-// 16.1 Singleton Pattern
-class Singleton {
+void benchSegmentedList() {
+    cout << "\n--- Sequence containers (ns per push_back / push_front / iterated element / middle insert) ---" << endl;
+    cout << setw(10) << "elements" << setw(16) << "container" << setw(12) << "push_back" << setw(12) << "push_front"
+         << setw(10) << "iterate" << setw(10) << "insert" << endl;
+    
+    for (size_t n : sizeSweep()) {
+        if (n > 10000000) break;
+        // A vector insert moves n/2 elements, so keep the count modest
+        size_t inserts = min<size_t>(n, 1000);
+        auto print = [&](const char* name, array<double, 4> ns) {
+            cout << setw(10) << n << setw(16) << name;
+            int widths[] = {12, 12, 10, 10};
+            for (int i = 0; i < 4; i++) {
+                stringstream ss;
+                if (isnan(ns[i])) ss << "-";
+                else ss << fixed << setprecision(ns[i] < 10 ? 2 : 1) << ns[i];
+                cout << setw(widths[i]) << ss.str();
+            }
+            cout << endl;
+        };
+        print("list", sequenceTimes<list<uint64_t>>(n, inserts));
+        print("deque", sequenceTimes<deque<uint64_t>>(n, inserts));
+        print("vector", sequenceTimes<vector<uint64_t>>(n, inserts));
+        print("SegmentedList", sequenceTimes<SegmentedList<uint64_t>>(n, inserts));
+    }
+    
+    // FIFO churn: chunks drained at the front are reused at the back
+    size_t ops = min<size_t>(benchConfig.maxN, 10000000);
+    auto fifo = [&](auto& queue) {
+        for (size_t i = 0; i < 1000; i++) queue.push_back(i);
+        return timeSeconds([&]() {
+            for (size_t i = 0; i < ops; i++) {
+                queue.push_back(i);
+                queue.pop_front();
+            }
+        }) * 1e9 / ops;
+    };
+    list<uint64_t> listQueue;
+    deque<uint64_t> dequeQueue;
+    SegmentedList<uint64_t> segmentedQueue;
+    double listNs = fifo(listQueue);
+    double dequeNs = fifo(dequeQueue);
+    double segmentedNs = fifo(segmentedQueue);
+    cout << "push_back + pop_front with 1000 queued: list " << fixed << setprecision(1) << listNs
+         << " ns, deque " << dequeNs << " ns, SegmentedList " << segmentedNs << " ns" << defaultfloat << endl;
+}
+
+// What production code does without a lock-free queue: std::queue behind a
+// mutex, with condition variables for "not empty" and "not full"
+template<typename T>
+class LockedQueue {
 private:
-    static Singleton* instance;
-    Singleton() = default;  // Private constructor
+    queue<T> items;
+    size_t limit;
+    mutex lock;
+    condition_variable notEmpty;
+    condition_variable notFull;
     
 public:
-    static Singleton* getInstance() {
-        if (instance == nullptr) {
-            instance = new Singleton();
+    using value_type = T;
+    
+    explicit LockedQueue(size_t capacity) : limit(capacity) {}
+    
+    void push(const T& value) {
+        {
+            unique_lock<mutex> guard(lock);
+            notFull.wait(guard, [this]() { return items.size() < limit; });
+            items.push(value);
         }
-        return instance;
+        notEmpty.notify_one();
     }
     
-    void doSomething() {
-        cout << "Singleton is doing something..." << endl;
+    T pop() {
+        T value;
+        {
+            unique_lock<mutex> guard(lock);
+            notEmpty.wait(guard, [this]() { return !items.empty(); });
+            value = move(items.front());
+            items.pop();
+        }
+        notFull.notify_one();
+        return value;
+    }
+    
+    void pushBatch(span<const T> values) {
+        while (!values.empty()) {
+            size_t n;
+            {
+                unique_lock<mutex> guard(lock);
+                notFull.wait(guard, [this]() { return items.size() < limit; });
+                n = min(values.size(), limit - items.size());
+                for (size_t i = 0; i < n; i++) items.push(values[i]);
+            }
+            notEmpty.notify_all();
+            values = values.subspan(n);
+        }
     }
     
-    // Delete copy constructor and assignment operator
-    Singleton(const Singleton&) = delete;
-    Singleton& operator=(const Singleton&) = delete;
+    size_t popBatch(span<T> out) {
+        size_t n;
+        {
+            unique_lock<mutex> guard(lock);
+            notEmpty.wait(guard, [this]() { return !items.empty(); });
+            n = min(out.size(), items.size());
+            for (size_t i = 0; i < n; i++) {
+                out[i] = move(items.front());
+                items.pop();
+            }
+        }
+        notFull.notify_all();
+        return n;
+    }
 };
 
-Singleton* Singleton::instance = nullptr;
-
-// 16.2 Observer Pattern
-class Observer {
-public:
-    virtual ~Observer() = default;
-    virtual void update(int value) = 0;
+struct QueueRun {
+    double messagesPerSecond;
+    uint64_t p50Ns;
+    uint64_t p99Ns;
 };
 
-class Subject {
-private:
-    vector<Observer*> observers;
-    int state;
-    
-public:
-    void addObserver(Observer* obs) {
-        observers.push_back(obs);
+uint64_t steadyNowNs() {
+    return chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// Producers send steady_clock timestamps; consumers record now - timestamp.
+// Every queue runs near full here, so this is queueing latency: mostly time
+// spent behind up to 1024 earlier messages, not the cost of one handoff.
+template<typename Queue>
+QueueRun runQueue(unsigned producers, unsigned consumers, size_t messages, size_t batch) {
+    constexpr uint64_t STOP = numeric_limits<uint64_t>::max();
+    Queue q(1024);
+    vector<LatencyHistogram> histograms(consumers);
+    size_t perProducer = messages / producers;
+    
+    vector<thread> consumerThreads;
+    auto start = chrono::steady_clock::now();
+    for (unsigned c = 0; c < consumers; c++) {
+        consumerThreads.emplace_back([&, c]() {
+            LatencyHistogram& histogram = histograms[c];
+            vector<uint64_t> buffer(batch);
+            while (true) {
+                size_t n = batch == 1 ? (buffer[0] = q.pop(), 1) : q.popBatch(buffer);
+                uint64_t now = steadyNowNs();
+                size_t stops = 0;
+                for (size_t i = 0; i < n; i++) {
+                    if (buffer[i] == STOP) stops++;
+                    else histogram.record(now > buffer[i] ? now - buffer[i] : 0);
+                }
+                if (stops > 0) {
+                    // Hand back stop markers meant for the other consumers
+                    for (size_t i = 1; i < stops; i++) q.push(STOP);
+                    return;
+                }
+            }
+        });
     }
-    
-    void removeObserver(Observer* obs) {
-        observers.erase(remove(observers.begin(), observers.end(), obs), observers.end());
+    timeThreads(producers, [&](unsigned) {
+        vector<uint64_t> buffer(batch);
+        for (size_t sent = 0; sent < perProducer; sent += batch) {
+            size_t n = min(batch, perProducer - sent);
+            if (n == 1) {
+                q.push(steadyNowNs());
+                continue;
+            }
+            fill_n(buffer.begin(), n, steadyNowNs());
+            q.pushBatch(span<const uint64_t>(buffer.data(), n));
+        }
+    });
+    for (unsigned c = 0; c < consumers; c++) q.push(STOP);
+    for (auto& th : consumerThreads) th.join();
+    double elapsed = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    
+    LatencyHistogram total;
+    for (const auto& h : histograms) total.merge(h);
+    return {perProducer * producers / elapsed, total.percentile(50), total.percentile(99)};
+}
+
+// One message in flight at a time: the sender waits for an ack on a second
+// queue before the next timestamp, so every message finds the queue empty and
+// the consumer's now - timestamp is pure handoff latency, wakeup included.
+template<typename Queue>
+QueueRun runPingPong(size_t roundTrips) {
+    Queue ping(1024), pong(1024);
+    LatencyHistogram histogram;
+    auto start = chrono::steady_clock::now();
+    thread receiver([&]() {
+        for (size_t i = 0; i < roundTrips; i++) {
+            uint64_t sent = ping.pop();
+            uint64_t now = steadyNowNs();
+            histogram.record(now > sent ? now - sent : 0);
+            pong.push(uint64_t(0));
+        }
+    });
+    for (size_t i = 0; i < roundTrips; i++) {
+        ping.push(steadyNowNs());
+        pong.pop();
+    }
+    receiver.join();
+    double elapsed = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    return {roundTrips / elapsed, histogram.percentile(50), histogram.percentile(99)};
+}
+
+void benchQueues() {
+    cout << "\n--- Producer/consumer queues, saturated (messages/sec, queueing latency) ---" << endl;
+    cout << setw(30) << "queue" << setw(8) << "P/C" << setw(8) << "batch" << setw(12) << "msgs/sec"
+         << setw(12) << "p50 ns" << setw(12) << "p99 ns" << endl;
+    
+    const size_t messages = max<size_t>(1000, min<size_t>(benchConfig.maxN, 2000000));
+    auto print = [](const char* name, unsigned p, unsigned c, size_t batch, QueueRun run) {
+        cout << setw(30) << name << setw(8) << (to_string(p) + "/" + to_string(c)) << setw(8) << batch
+             << setw(12) << humanRate(run.messagesPerSecond) << setw(12) << run.p50Ns
+             << setw(12) << run.p99Ns << endl;
+    };
+    
+    for (size_t batch : {size_t(1), size_t(32)}) {
+        print("SpscQueue (blocking)", 1, 1, batch, runQueue<BlockingQueue<SpscQueue<uint64_t>>>(1, 1, messages, batch));
+        print("BoundedQueue (blocking)", 1, 1, batch, runQueue<BlockingQueue<BoundedQueue<uint64_t>>>(1, 1, messages, batch));
+        print("mutex + condvar queue", 1, 1, batch, runQueue<LockedQueue<uint64_t>>(1, 1, messages, batch));
     }
     
-    void setState(int newState) {
-        state = newState;
-        notifyObservers();
+    // SPSC cannot take several threads per side; MPMC splits the threads
+    unsigned side = max(2u, benchConfig.maxThreads / 2);
+    for (size_t batch : {size_t(1), size_t(32)}) {
+        print("BoundedQueue (blocking)", side, side, batch,
+              runQueue<BlockingQueue<BoundedQueue<uint64_t>>>(side, side, messages, batch));
+        print("mutex + condvar queue", side, side, batch, runQueue<LockedQueue<uint64_t>>(side, side, messages, batch));
     }
     
-    int getState() const { return state; }
+    // Every round trip pays two wakeups, so run far fewer of them
+    const size_t roundTrips = max<size_t>(1000, min<size_t>(messages / 20, 50000));
+    cout << "\n--- Producer/consumer queues, ping-pong (round trips/sec, handoff latency) ---" << endl;
+    cout << setw(30) << "queue" << setw(8) << "P/C" << setw(8) << "batch" << setw(12) << "trips/sec"
+         << setw(12) << "p50 ns" << setw(12) << "p99 ns" << endl;
+    print("SpscQueue (blocking)", 1, 1, 1, runPingPong<BlockingQueue<SpscQueue<uint64_t>>>(roundTrips));
+    print("BoundedQueue (blocking)", 1, 1, 1, runPingPong<BlockingQueue<BoundedQueue<uint64_t>>>(roundTrips));
+    print("mutex + condvar queue", 1, 1, 1, runPingPong<LockedQueue<uint64_t>>(roundTrips));
+}
+
+// Random directed graph in compressed sparse row form
+struct WeightedGraph {
+    vector<uint32_t> offsets;   // Edges of node v are [offsets[v], offsets[v + 1])
+    vector<uint32_t> targets;
+    vector<uint32_t> weights;
     
-private:
-    void notifyObservers() {
-        for (auto* obs : observers) {
-            obs->update(state);
-        }
-    }
+    size_t nodes() const { return offsets.size() - 1; }
 };
 
-class ConcreteObserver : public Observer {
-private:
-    string name;
-    
-public:
-    ConcreteObserver(const string& n) : name(n) {}
-    
-    void update(int value) override {
-        cout << "Observer " << name << " received update: " << value << endl;
+WeightedGraph randomGraph(size_t nodes, size_t degree, mt19937_64& rng) {
+    WeightedGraph g;
+    g.offsets.resize(nodes + 1);
+    g.targets.resize(nodes * degree);
+    g.weights.resize(nodes * degree);
+    for (size_t v = 0; v <= nodes; v++) g.offsets[v] = uint32_t(v * degree);
+    for (size_t e = 0; e < nodes * degree; e++) {
+        g.targets[e] = uint32_t(rng() % nodes);
+        g.weights[e] = uint32_t(1 + rng() % 1000);
     }
-};
+    return g;
+}
 
-// 16.3 Factory Pattern
-class Product {
-public:
-    virtual ~Product() = default;
-    virtual void use() = 0;
+struct ShortestPaths {
+    vector<uint64_t> dist;
+    size_t pushes = 0;
+    size_t decreases = 0;
+    size_t pops = 0;
+    size_t peakSize = 0;
 };
 
-class ConcreteProductA : public Product {
-public:
-    void use() override {
-        cout << "Using Product A" << endl;
+constexpr uint64_t UNREACHED = numeric_limits<uint64_t>::max();
+
+// Lazy deletion: a shorter path pushes a duplicate; stale entries are skipped
+ShortestPaths dijkstraBinaryHeap(const WeightedGraph& g) {
+    ShortestPaths r;
+    r.dist.assign(g.nodes(), UNREACHED);
+    priority_queue<pair<uint64_t, uint32_t>, vector<pair<uint64_t, uint32_t>>, greater<>> heap;
+    r.dist[0] = 0;
+    heap.push({0, 0});
+    r.pushes++;
+    while (!heap.empty()) {
+        r.peakSize = max(r.peakSize, heap.size());
+        auto [d, v] = heap.top();
+        heap.pop();
+        r.pops++;
+        if (d != r.dist[v]) continue;
+        for (uint32_t e = g.offsets[v]; e < g.offsets[v + 1]; e++) {
+            uint64_t nd = d + g.weights[e];
+            uint32_t t = g.targets[e];
+            if (nd < r.dist[t]) {
+                r.dist[t] = nd;
+                heap.push({nd, t});
+                r.pushes++;
+            }
+        }
     }
-};
+    return r;
+}
 
-class ConcreteProductB : public Product {
-public:
-    void use() override {
-        cout << "Using Product B" << endl;
+ShortestPaths dijkstraIndexedHeap(const WeightedGraph& g) {
+    ShortestPaths r;
+    r.dist.assign(g.nodes(), UNREACHED);
+    IndexedHeap<uint64_t> heap(g.nodes());
+    r.dist[0] = 0;
+    heap.push(0, 0);
+    r.pushes++;
+    while (!heap.empty()) {
+        r.peakSize = max(r.peakSize, heap.size());
+        uint32_t v = heap.pop();
+        r.pops++;
+        uint64_t d = r.dist[v];
+        for (uint32_t e = g.offsets[v]; e < g.offsets[v + 1]; e++) {
+            uint64_t nd = d + g.weights[e];
+            uint32_t t = g.targets[e];
+            if (nd < r.dist[t]) {
+                if (r.dist[t] == UNREACHED) {
+                    heap.push(t, nd);
+                    r.pushes++;
+                } else {
+                    heap.decreaseKey(t, nd);
+                    r.decreases++;
+                }
+                r.dist[t] = nd;
+            }
+        }
     }
-};
+    return r;
+}
 
-class Factory {
-public:
-    enum ProductType { TYPE_A, TYPE_B };
-    
-    static unique_ptr<Product> createProduct(ProductType type) {
-        switch (type) {
-            case TYPE_A:
-                return make_unique<ConcreteProductA>();
-            case TYPE_B:
-                return make_unique<ConcreteProductB>();
-            default:
-                return nullptr;
+// Radix heaps have no decrease-key either, but pushes are appends
+ShortestPaths dijkstraRadixHeap(const WeightedGraph& g) {
+    ShortestPaths r;
+    r.dist.assign(g.nodes(), UNREACHED);
+    RadixHeap<uint32_t> heap;
+    r.dist[0] = 0;
+    heap.push(0, 0);
+    r.pushes++;
+    while (!heap.empty()) {
+        r.peakSize = max(r.peakSize, heap.size());
+        auto [d, v] = heap.pop();
+        r.pops++;
+        if (d != r.dist[v]) continue;
+        for (uint32_t e = g.offsets[v]; e < g.offsets[v + 1]; e++) {
+            uint64_t nd = d + g.weights[e];
+            uint32_t t = g.targets[e];
+            if (nd < r.dist[t]) {
+                r.dist[t] = nd;
+                heap.push(nd, t);
+                r.pushes++;
+            }
         }
     }
-};
+    return r;
+}
 
-void designPatterns() {
-    cout << "\n=== DESIGN PATTERNS ===" << endl;
-    
-    // Singleton
-    cout << "--- Singleton Pattern ---" << endl;
-    Singleton* s1 = Singleton::getInstance();
-    Singleton* s2 = Singleton::getInstance();
-    cout << "Same instance: " << boolalpha << (s1 == s2) << endl;
-    s1->doSomething();
-    
-    // Observer
-    cout << "\n--- Observer Pattern ---" << endl;
-    Subject subject;
-    ConcreteObserver obs1("Observer1");
-    ConcreteObserver obs2("Observer2");
-    
-    subject.addObserver(&obs1);
-    subject.addObserver(&obs2);
-    
-    subject.setState(42);
-    subject.setState(100);
-    
-    // Factory
-    cout << "\n--- Factory Pattern ---" << endl;
-    auto productA = Factory::createProduct(Factory::TYPE_A);
-    auto productB = Factory::createProduct(Factory::TYPE_B);
+void benchPriorityQueues() {
+    cout << "\n--- Dijkstra on random graphs, 8 edges per node (ms, heap operations, peak heap size) ---" << endl;
+    cout << setw(10) << "nodes" << setw(26) << "heap" << setw(10) << "ms" << setw(12) << "ops"
+         << setw(12) << "decreases" << setw(12) << "peak" << setw(10) << "ns/op" << endl;
+    
+    mt19937_64 rng(25);
+    // About 3.6 heap operations per node: 10^6 and 10^7 operations in total
+    for (size_t nodes : {size_t(300000), size_t(3000000)}) {
+        if (nodes > benchConfig.maxN) break;
+        WeightedGraph g = randomGraph(nodes, 8, rng);
+        uint64_t reference = 0;
+        auto run = [&](const char* name, ShortestPaths (*solve)(const WeightedGraph&)) {
+            ShortestPaths r;
+            double seconds = timeSeconds([&]() { r = solve(g); });
+            uint64_t checksum = 0;
+            for (uint64_t d : r.dist) checksum += d == UNREACHED ? 0 : d;
+            if (reference == 0) reference = checksum;
+            size_t ops = r.pushes + r.decreases + r.pops;
+            stringstream perOp;
+            perOp << fixed << setprecision(1) << seconds * 1e9 / ops;
+            cout << setw(10) << nodes << setw(26) << name << setw(10) << (long long)(seconds * 1e3)
+                 << setw(12) << ops << setw(12) << r.decreases << setw(12) << r.peakSize
+                 << setw(10) << perOp.str() << (checksum == reference ? "" : "  MISMATCH") << endl;
+        };
+        run("priority_queue (lazy)", dijkstraBinaryHeap);
+        run("IndexedHeap (4-ary)", dijkstraIndexedHeap);
+        run("RadixHeap (lazy)", dijkstraRadixHeap);
+    }
+}
+
+int runBenchmarks(int argc, char* argv[]) {
+    for (int i = 2; i < argc; i++) {
+        string arg = argv[i];
+        if (arg.rfind("--max-n=", 0) == 0) {
+            benchConfig.maxN = stoull(arg.substr(8));
+        } else if (arg.rfind("--threads=", 0) == 0) {
+            benchConfig.maxThreads = max(1u, (unsigned)stoul(arg.substr(10)));
+        } else {
+            benchConfig.filter = arg;
+        }
+    }
     
-    productA->use();
-    productB->use();
+    vector<pair<string, function<void()>>> benchmarks = {
+        {"counter", benchCounters},
+        {"threadpool", benchThreadPool},
+        {"shapes", benchShapeStore},
+        {"simd", benchSimdKernels},
+        {"geometry", benchGeometry},
+        {"spatial", benchSpatialIndex},
+        {"sort", benchSortSearch},
+        {"hashmap", benchHashMaps},
+        {"flatmap", benchFlatMaps},
+        {"segmented", benchSegmentedList},
+        {"heap", benchPriorityQueues},
+        {"stack", benchStacks},
+        {"concurrent-stack", benchConcurrentStack},
+        {"fileio", benchFileIO},
+        {"parse", benchParsing},
+        {"output", benchOutput},
+        {"observer", benchObservers},
+        {"eventbus", benchEventBus},
+        {"queues", benchQueues},
+        {"singleton", benchSingleton},
+        {"factory", benchFactories},
+        {"bufferpool", benchBufferPool},
+        {"sbo", benchSmallBuffer},
+        {"rectangles", benchRectangles},
+    };
+    
+    cout << "Benchmarks (max N = " << benchConfig.maxN
+         << ", max threads = " << benchConfig.maxThreads << ")" << endl;
+    for (const auto& bench : benchmarks) {
+        if (benchConfig.filter.empty() || bench.first == benchConfig.filter) {
+            bench.second();
+        }
+    }
+    return 0;
 }
 
 /*
@@ -1387,7 +8315,11 @@ void designPatterns() {
 ===============================================================================
 */
 
-int main() {
+int main(int argc, char* argv[]) {
+    if (argc > 1 && string(argv[1]) == "--bench") {
+        return runBenchmarks(argc, argv);
+    }
+    
     cout << "===========================================" << endl;
     cout << "    COMPLETE C++ LEARNING GUIDE" << endl;
     cout << "    From Basic to Advanced Topics" << endl;
@@ -1414,10 +8346,11 @@ int main() {
         
         // Create some objects to demonstrate OOP
         cout << "\n=== CLASSES AND OBJECTS ===" << endl;
-        Rectangle rect(5.0, 3.0);
+        LoggedRectangle rect(5.0, 3.0);  // Logs when destroyed
         cout << "Rectangle area: " << rect.area() << endl;
         cout << "Rectangle perimeter: " << rect.perimeter() << endl;
         printRectangle(rect);
+        cout << "Rectangles alive: " << LoggedRectangle::getObjectCount() << endl;
         
         polymorphismExample();
         
@@ -1442,6 +8375,8 @@ int main() {
         return 1;
     }
     
+    // Empty unless built with -DGUIDE_LIFECYCLE_STATS
+    LifecycleStats::report();
     return 0;
 }
 
@@ -1452,10 +8387,14 @@ int main() {
 
 COMPILATION:
 To compile this program, use:
-g++ -std=c++14 -pthread -o cpp_guide cpp_guide.cpp
+g++ -std=c++20 -O2 -pthread -o cpp_guide cpp_guide.cpp
 
-Or for more recent features:
-g++ -std=c++17 -pthread -o cpp_guide cpp_guide.cpp
+BENCHMARKS:
+Section 17 is only run when asked for:
+./cpp_guide --bench                  (all benchmarks)
+./cpp_guide --bench counter          (a single benchmark)
+./cpp_guide --bench --max-n=1000000000 --threads=32
+Add -DGUIDE_PARALLEL_STL -ltbb to also benchmark std::sort(std::execution::par).
 
 STUDY PROGRESSION:
 1. Start with sections 1-3 (Basics, Control Structures, Functions)